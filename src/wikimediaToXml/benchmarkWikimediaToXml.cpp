@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Program for benchmarking alternative implementations of parts of strusWikimediaToXml against each other
+/// \file benchmarkWikimediaToXml.cpp
+#include "mappedFile.hpp"
+#include "pageScanner.hpp"
+#include "wikimediaLexer.hpp"
+#include "plainTextScan.hpp"
+#include "tagSearch.hpp"
+#include "monotonicClock.hpp"
+#include "strus/base/numstring.hpp"
+#include "strus/base/string_format.hpp"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <limits>
+
+/// \brief Summary of the pages extracted, used to check that the implementations compared produce the same result
+struct PageStatistics
+{
+	int nofPages;
+	std::size_t nofBytes;
+	unsigned int checksum;
+
+	PageStatistics()
+		:nofPages(0),nofBytes(0),checksum(0){}
+
+	void add( const std::string& str)
+	{
+		std::string::const_iterator si = str.begin(), se = str.end();
+		for (; si != se; ++si) checksum = checksum * 31 + (unsigned char)*si;
+		nofBytes += str.size();
+	}
+	void add( const strus::PageAttributes& page)
+	{
+		++nofPages;
+		checksum = checksum * 31 + page.ns;
+		add( page.title);
+		add( page.redirect_title);
+		add( page.content);
+		add( page.page_id);
+		add( page.revision_id);
+		add( page.sha1);
+	}
+	bool operator == (const PageStatistics& o) const
+	{
+		return nofPages == o.nofPages && nofBytes == o.nofBytes && checksum == o.checksum;
+	}
+	std::string tostring() const
+	{
+		return strus::string_format( "pages %d, bytes %lu, checksum %08x", nofPages, (unsigned long)nofBytes, checksum);
+	}
+};
+
+struct PageStatisticsHandler
+{
+	PageStatistics stats;
+
+	void openPage( std::size_t){}
+	void closePage( const strus::PageAttributes& page)
+	{
+		stats.add( page);
+	}
+};
+
+static PageStatistics scanPagesXml( const strus::MappedFile& input, const strus::PageFilter* filter)
+{
+	PageStatisticsHandler handler;
+	strus::scanPagesXml( strus::MemoryInputIterator( input.begin(), input.end()), handler, filter, false);
+	return handler.stats;
+}
+
+static PageStatistics scanPagesFast( const strus::MappedFile& input, const strus::PageFilter* filter)
+{
+	PageStatisticsHandler handler;
+	strus::PageExtractor extractor( input.begin(), input.end(), filter);
+	strus::PageAttributes page;
+	for (;;)
+	{
+		strus::PageExtractor::Result res = extractor.next( page);
+		if (res == strus::PageExtractor::EndOfInput)
+		{
+			break;
+		}
+		else if (res == strus::PageExtractor::Anomaly)
+		{
+			strus::scanPagesXml( strus::MemoryInputIterator( extractor.pagestart(), extractor.pageend()), handler, filter, false);
+		}
+		else
+		{
+			handler.closePage( page);
+		}
+	}
+	return handler.stats;
+}
+
+typedef PageStatistics (*ScanPagesFunction)( const strus::MappedFile& input, const strus::PageFilter* filter);
+
+static PageStatistics runBenchmark( const char* name, ScanPagesFunction func, const strus::MappedFile& input, int nofIterations)
+{
+	PageStatistics rt;
+	double startTime = strus::monotonicTimeSeconds();
+	for (int ii=0; ii<nofIterations; ++ii)
+	{
+		rt = func( input, NULL/*filter*/);
+	}
+	double duration = strus::monotonicTimeSeconds() - startTime;
+	double mbPerSecond = duration > 0.0 ? ((double)input.size() * nofIterations / duration / (1024.0 * 1024.0)) : 0.0;
+	std::cout << strus::string_format( "%-12s %8.3f seconds, %8.1f MB/s (%s)", name, duration, mbPerSecond, rt.tostring().c_str()) << std::endl;
+	return rt;
+}
+
+static void benchmarkPages( const std::string& inputpath, int nofIterations)
+{
+	strus::MappedFile input( inputpath);
+	PageStatistics xmlstats = runBenchmark( "xmlscanner", &scanPagesXml, input, nofIterations);
+	PageStatistics faststats = runBenchmark( "fastscan", &scanPagesFast, input, nofIterations);
+	if (!(xmlstats == faststats))
+	{
+		throw std::runtime_error( "results of page scanners differ");
+	}
+}
+
+struct PageContentCollector
+{
+	std::vector<std::string> contents;
+	std::size_t nofBytes;
+
+	PageContentCollector()
+		:contents(),nofBytes(0){}
+
+	void openPage( std::size_t){}
+	void closePage( const strus::PageAttributes& page)
+	{
+		contents.push_back( page.content);
+		nofBytes += page.content.size();
+	}
+};
+
+/// \brief Summary of the lexems of the pages, used to check that the lexer implementations compared produce the same result
+struct LexemStatistics
+{
+	int nofLexems;
+	unsigned int checksum;
+
+	LexemStatistics()
+		:nofLexems(0),checksum(0){}
+
+	void add( const strus::WikimediaLexem& lexem)
+	{
+		this->lexem( lexem.id, lexem.idx, lexem.value.data(), lexem.value.size(), lexem.attributes);
+	}
+	//... handler interface of WikimediaLexer::parse
+	void lexem( strus::WikimediaLexem::Id id, int idx, const char* value, std::size_t valuesize, const strus::WikimediaLexem::AttributeMap& attributes)
+	{
+		++nofLexems;
+		checksum = checksum * 31 + (unsigned int)id;
+		checksum = checksum * 31 + (unsigned int)idx;
+		const char* vi = value;
+		const char* ve = vi + valuesize;
+		for (; vi != ve; ++vi) checksum = checksum * 31 + (unsigned char)*vi;
+		strus::WikimediaLexem::AttributeMap::const_iterator ai = attributes.begin(), ae = attributes.end();
+		for (; ai != ae; ++ai)
+		{
+			std::string::const_iterator si = ai->first.begin(), se = ai->first.end();
+			for (; si != se; ++si) checksum = checksum * 31 + (unsigned char)*si;
+			si = ai->second.begin(), se = ai->second.end();
+			for (; si != se; ++si) checksum = checksum * 31 + (unsigned char)*si;
+		}
+	}
+	bool operator == (const LexemStatistics& o) const
+	{
+		return nofLexems == o.nofLexems && checksum == o.checksum;
+	}
+	std::string tostring() const
+	{
+		return strus::string_format( "lexems %d, checksum %08x", nofLexems, checksum);
+	}
+};
+
+/// \param[in] push true if the lexems are passed to a handler (WikimediaLexer::parse), false if they are fetched with WikimediaLexer::next
+static LexemStatistics runLexerBenchmark( const char* name, strus::PlainTextStopMaskFunction stopMaskFunc, bool push, const PageContentCollector& pages, int nofIterations)
+{
+	LexemStatistics rt;
+	double startTime = strus::monotonicTimeSeconds();
+	for (int ii=0; ii<nofIterations; ++ii)
+	{
+		rt = LexemStatistics();
+		std::vector<std::string>::const_iterator ci = pages.contents.begin(), ce = pages.contents.end();
+		for (; ci != ce; ++ci)
+		{
+			strus::WikimediaLexer lexer( ci->c_str(), ci->size(), stopMaskFunc);
+			if (push)
+			{
+				lexer.parse( rt);
+				continue;
+			}
+			for (strus::WikimediaLexem lexem = lexer.next(); lexem.id != strus::WikimediaLexem::EoF; lexem = lexer.next())
+			{
+				rt.add( lexem);
+			}
+		}
+	}
+	double duration = strus::monotonicTimeSeconds() - startTime;
+	double mbPerSecond = duration > 0.0 ? ((double)pages.nofBytes * nofIterations / duration / (1024.0 * 1024.0)) : 0.0;
+	std::cout << strus::string_format( "%-12s %8.3f seconds, %8.1f MB/s (%s)", name, duration, mbPerSecond, rt.tostring().c_str()) << std::endl;
+	return rt;
+}
+
+static void benchmarkLexer( const std::string& inputpath, int nofIterations)
+{
+	strus::MappedFile input( inputpath);
+	PageContentCollector pages;
+	strus::scanPagesXml( strus::MemoryInputIterator( input.begin(), input.end()), pages, NULL/*filter*/, false);
+
+	LexemStatistics bytewise = runLexerBenchmark( "bytewise", NULL, false, pages, nofIterations);
+	LexemStatistics scalar = runLexerBenchmark( "scalar", &strus::plainTextStopMaskScalar, false, pages, nofIterations);
+	if (!(bytewise == scalar))
+	{
+		throw std::runtime_error( "results of lexer with scalar plain text scan differ");
+	}
+	if (strus::plainTextStopMaskSse2)
+	{
+		LexemStatistics sse2 = runLexerBenchmark( "sse2", strus::plainTextStopMaskSse2, false, pages, nofIterations);
+		if (!(bytewise == sse2))
+		{
+			throw std::runtime_error( "results of lexer with SSE2 plain text scan differ");
+		}
+	}
+	LexemStatistics parse = runLexerBenchmark( "parse", strus::plainTextStopMaskDefault, true, pages, nofIterations);
+	if (!(bytewise == parse))
+	{
+		throw std::runtime_error( "results of lexer passing lexems to a handler differ");
+	}
+}
+
+/// \brief Names of the tags in the pages as they are looked up by the lexer
+struct TagNameCollector
+{
+	std::vector<std::pair<const char*,std::size_t> > names;
+
+	explicit TagNameCollector( const PageContentCollector& pages)
+	{
+		std::vector<std::string>::const_iterator ci = pages.contents.begin(), ce = pages.contents.end();
+		for (; ci != ce; ++ci)
+		{
+			const char* si = ci->c_str();
+			const char* se = si + ci->size();
+			for (si = (const char*)std::memchr( si, '<', se - si); si; si = (const char*)std::memchr( si, '<', se - si))
+			{
+				++si;
+				if (si < se && *si == '/') ++si;
+				const char* name = si;
+				for (; si < se && ((*si|32) >= 'a' && (*si|32) <= 'z'); ++si){}
+				if (si > name) names.push_back( std::pair<const char*,std::size_t>( name, si - name));
+			}
+		}
+	}
+};
+
+typedef int (strus::TagNameTable::*FindTagNameMethod)( const char* name, std::size_t namelen) const;
+
+static unsigned int runTagNameBenchmark( const char* name, FindTagNameMethod method, const TagNameCollector& tagnames, int nofIterations)
+{
+	const strus::TagNameTable& table = strus::wikimediaTagNameTable();
+	unsigned int rt = 0;
+	int nofFound = 0;
+	double startTime = strus::monotonicTimeSeconds();
+	for (int ii=0; ii<nofIterations; ++ii)
+	{
+		rt = 0;
+		nofFound = 0;
+		std::vector<std::pair<const char*,std::size_t> >::const_iterator ni = tagnames.names.begin(), ne = tagnames.names.end();
+		for (; ni != ne; ++ni)
+		{
+			int idx = (table.*method)( ni->first, ni->second);
+			rt = rt * 31 + (unsigned int)(idx + 1);
+			if (idx >= 0) ++nofFound;
+		}
+	}
+	double duration = strus::monotonicTimeSeconds() - startTime;
+	double namesPerSecond = duration > 0.0 ? ((double)tagnames.names.size() * nofIterations / duration) : 0.0;
+	std::cout << strus::string_format( "%-12s %8.3f seconds, %8.1f M lookups/s (names %d, found %d, checksum %08x)", name, duration, namesPerSecond / 1000000.0, (int)tagnames.names.size(), nofFound, rt) << std::endl;
+	return rt;
+}
+
+static void benchmarkTags( const std::string& inputpath, int nofIterations)
+{
+	strus::MappedFile input( inputpath);
+	PageContentCollector pages;
+	strus::scanPagesXml( strus::MemoryInputIterator( input.begin(), input.end()), pages, NULL/*filter*/, false);
+	TagNameCollector tagnames( pages);
+
+	//... the lookup is fast compared with the time measurement, so it is repeated
+	unsigned int sequential = runTagNameBenchmark( "sequential", &strus::TagNameTable::findSequential, tagnames, nofIterations * 100);
+	unsigned int hash = runTagNameBenchmark( "hash", &strus::TagNameTable::find, tagnames, nofIterations * 100);
+	if (sequential != hash)
+	{
+		throw std::runtime_error( "results of tag name lookups differ");
+	}
+}
+
+/// \brief Summary of the matches of a search, used to check that the implementations compared produce the same result
+struct SearchStatistics
+{
+	int nofMatches;
+	unsigned int checksum;
+
+	SearchStatistics()
+		:nofMatches(0),checksum(0){}
+
+	bool operator == (const SearchStatistics& o) const
+	{
+		return nofMatches == o.nofMatches && checksum == o.checksum;
+	}
+	std::string tostring() const
+	{
+		return strus::string_format( "matches %d, checksum %08x", nofMatches, checksum);
+	}
+};
+
+static SearchStatistics runTagSearchBenchmark( const char* name, strus::TagSearchFunction func, const PageContentCollector& pages, int nofIterations)
+{
+	SearchStatistics rt;
+	double startTime = strus::monotonicTimeSeconds();
+	for (int ii=0; ii<nofIterations; ++ii)
+	{
+		rt = SearchStatistics();
+		std::vector<std::string>::const_iterator ci = pages.contents.begin(), ce = pages.contents.end();
+		for (; ci != ce; ++ci)
+		{
+			const char* si = ci->c_str();
+			const char* se = si + ci->size();
+			for (const char* mi = func( si, se); mi; mi = func( mi+1, se))
+			{
+				++rt.nofMatches;
+				rt.checksum = rt.checksum * 31 + (unsigned int)(mi - si);
+			}
+		}
+	}
+	double duration = strus::monotonicTimeSeconds() - startTime;
+	double mbPerSecond = duration > 0.0 ? ((double)pages.nofBytes * nofIterations / duration / (1024.0 * 1024.0)) : 0.0;
+	std::cout << strus::string_format( "%-12s %8.3f seconds, %8.1f MB/s (%s)", name, duration, mbPerSecond, rt.tostring().c_str()) << std::endl;
+	return rt;
+}
+
+static void benchmarkTagSearch( const std::string& inputpath, int nofIterations)
+{
+	strus::MappedFile input( inputpath);
+	PageContentCollector pages;
+	strus::scanPagesXml( strus::MemoryInputIterator( input.begin(), input.end()), pages, NULL/*filter*/, false);
+
+	SearchStatistics closeTagScalar = runTagSearchBenchmark( "close scalar", &strus::findCloseTagStartScalar, pages, nofIterations);
+	SearchStatistics commentScalar = runTagSearchBenchmark( "-->  scalar", &strus::findCommentEndScalar, pages, nofIterations);
+	if (strus::findCloseTagStartSse2)
+	{
+		SearchStatistics closeTagSse2 = runTagSearchBenchmark( "close sse2", strus::findCloseTagStartSse2, pages, nofIterations);
+		if (!(closeTagScalar == closeTagSse2))
+		{
+			throw std::runtime_error( "results of close tag search differ");
+		}
+	}
+	if (strus::findCommentEndSse2)
+	{
+		SearchStatistics commentSse2 = runTagSearchBenchmark( "-->  sse2", strus::findCommentEndSse2, pages, nofIterations);
+		if (!(commentScalar == commentSse2))
+		{
+			throw std::runtime_error( "results of comment end search differ");
+		}
+	}
+}
+
+int main( int argc, const char* argv[])
+{
+	try
+	{
+		if (argc < 3 || argc > 4 || 0==std::strcmp( argv[1], "-h"))
+		{
+			if (argc > 4) std::cerr << "too many arguments" << std::endl;
+			std::cerr << "Usage: benchmarkWikimediaToXml <benchmark> <inputfile> [<iterations>]" << std::endl;
+			std::cerr << "<benchmark>   :Name of the benchmark to run, one of the following:" << std::endl;
+			std::cerr << "    pages        :Extract the pages of a dump with the generic XML scanner" << std::endl;
+			std::cerr << "                  and with the fast page extractor (option --fastscan)" << std::endl;
+			std::cerr << "    lexer        :Lex the contents of the pages looking at every byte and with" << std::endl;
+			std::cerr << "                  plain text skipped with the scalar and the SSE2 implementation," << std::endl;
+			std::cerr << "                  and passing the lexems to a handler" << std::endl;
+			std::cerr << "    tags         :Look up the names of the tags in the pages comparing them" << std::endl;
+			std::cerr << "                  one by one and with a perfect hash" << std::endl;
+			std::cerr << "    tagsearch    :Search the close tags and the ends of comments in the pages" << std::endl;
+			std::cerr << "                  with the scalar and the SSE2 implementation" << std::endl;
+			std::cerr << "<inputfile>   :Uncompressed Wikipedia XML dump file to process" << std::endl;
+			std::cerr << "<iterations>  :Number of iterations (default 1)" << std::endl;
+			std::cerr << "Returns an error if the implementations compared produce different results." << std::endl;
+			return argc < 3 ? -1 : 0;
+		}
+		int nofIterations = 1;
+		if (argc > 3)
+		{
+			nofIterations = strus::numstring_conv::touint( argv[3], std::numeric_limits<int>::max());
+			if (!nofIterations) throw std::runtime_error( "number of iterations must be a positive integer");
+		}
+		if (0==std::strcmp( argv[1], "pages"))
+		{
+			benchmarkPages( argv[2], nofIterations);
+		}
+		else if (0==std::strcmp( argv[1], "lexer"))
+		{
+			benchmarkLexer( argv[2], nofIterations);
+		}
+		else if (0==std::strcmp( argv[1], "tags"))
+		{
+			benchmarkTags( argv[2], nofIterations);
+		}
+		else if (0==std::strcmp( argv[1], "tagsearch"))
+		{
+			benchmarkTagSearch( argv[2], nofIterations);
+		}
+		else
+		{
+			throw std::runtime_error( strus::string_format( "unknown benchmark '%s'", argv[1]));
+		}
+		return 0;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+	}
+	return -1;
+}
+
@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Input stream decompressing a bzip2 multistream file with a pool of threads
+/// \file bzip2Input.cpp
+#include "bzip2Input.hpp"
+#include "strus/base/string_format.hpp"
+#include <bzlib.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+using namespace strus;
+
+static bool isStreamHeader( const char* si, const char* se)
+{
+	//... "BZh" + block size digit + block header magic (BCD pi)
+	return (se - si >= 10 && si[0] == 'B' && si[1] == 'Z' && si[2] == 'h' && si[3] >= '1' && si[3] <= '9'
+		&& 0==std::memcmp( si+4, "\x31\x41\x59\x26\x53\x59", 6));
+}
+
+static const char* findStreamHeader( const char* si, const char* se)
+{
+	for (;;)
+	{
+		const char* rt = (const char*)std::memchr( si, 'B', se-si);
+		if (!rt) return se;
+		if (isStreamHeader( rt, se)) return rt;
+		si = rt+1;
+	}
+}
+
+static std::string bzipErrorString( int ec)
+{
+	switch (ec)
+	{
+		case BZ_SEQUENCE_ERROR: return "sequence error";
+		case BZ_PARAM_ERROR: return "parameter error";
+		case BZ_MEM_ERROR: return "out of memory";
+		case BZ_DATA_ERROR: return "data integrity error";
+		case BZ_DATA_ERROR_MAGIC: return "bad magic number, not a bzip2 stream";
+		case BZ_IO_ERROR: return "io error";
+		case BZ_UNEXPECTED_EOF: return "unexpected end of data";
+		case BZ_OUTBUFF_FULL: return "output buffer full";
+		case BZ_CONFIG_ERROR: return "bad configuration";
+	}
+	return strus::string_format( "error code %d", ec);
+}
+
+/// \brief Decompresses a sequence of complete bzip2 streams, passing the output in pieces to a callback object
+template <class Sink>
+static void bzip2Decompress( const char* src, std::size_t srcsize, std::size_t piecesize, Sink& sink)
+{
+	std::string piece;
+	std::size_t piecepos = 0;
+	piece.resize( piecesize);
+
+	while (srcsize)
+	{
+		bz_stream strm;
+		std::memset( &strm, 0, sizeof(strm));
+		int ec = BZ2_bzDecompressInit( &strm, 0/*verbosity*/, 0/*small*/);
+		if (ec != BZ_OK) throw std::runtime_error( std::string("failed to initialize bzip2 decompression: ") + bzipErrorString( ec));
+		for (;;)
+		{
+			if (strm.avail_in == 0)
+			{
+				std::size_t nn = std::min( srcsize, (std::size_t)(1U<<30));
+				//... avail_in is an unsigned int, feed huge inputs in pieces
+				strm.next_in = const_cast<char*>( src);
+				strm.avail_in = nn;
+				src += nn;
+				srcsize -= nn;
+			}
+			strm.next_out = &piece[0] + piecepos;
+			strm.avail_out = piece.size() - piecepos;
+			ec = BZ2_bzDecompress( &strm);
+			piecepos = piece.size() - strm.avail_out;
+			if (piecepos == piece.size())
+			{
+				sink.push( piece, false);
+				piece.resize( piecesize);
+				piecepos = 0;
+			}
+			if (ec == BZ_STREAM_END)
+			{
+				break;
+			}
+			else if (ec != BZ_OK)
+			{
+				BZ2_bzDecompressEnd( &strm);
+				throw std::runtime_error( std::string("bzip2 decompression failed: ") + bzipErrorString( ec));
+			}
+			else if (strm.avail_in == 0 && srcsize == 0 && piecepos < piece.size())
+			{
+				BZ2_bzDecompressEnd( &strm);
+				throw std::runtime_error( "bzip2 decompression failed: unexpected end of data (bad stream offset ?)");
+			}
+		}
+		//... continue with the next stream in the segment:
+		src = strm.next_in;
+		srcsize += strm.avail_in;
+		BZ2_bzDecompressEnd( &strm);
+	}
+	piece.resize( piecepos);
+	sink.push( piece, true);
+}
+
+struct IndexParser
+{
+	std::vector<std::size_t> offsets;
+	std::string line;
+
+	void push( std::string& piece, bool last)
+	{
+		char const* si = piece.c_str();
+		const char* se = si + piece.size();
+		while (si < se)
+		{
+			const char* eoln = (const char*)std::memchr( si, '\n', se - si);
+			if (!eoln)
+			{
+				line.append( si, se - si);
+				break;
+			}
+			line.append( si, eoln - si);
+			addLine();
+			si = eoln + 1;
+		}
+		if (last && !line.empty()) addLine();
+	}
+
+	void addLine()
+	{
+		char const* li = line.c_str();
+		std::size_t offset = 0;
+		for (; *li >= '0' && *li <= '9'; ++li) offset = offset * 10 + (*li - '0');
+		if (*li != ':') throw std::runtime_error( strus::string_format( "syntax error in bzip2 multistream index file in line '%s'", line.c_str()));
+		if (offsets.empty() || offsets.back() != offset) offsets.push_back( offset);
+		line.clear();
+	}
+};
+
+void Bzip2MultistreamInput::loadIndex( const std::string& indexpath)
+{
+	MappedFile indexfile( indexpath);
+	IndexParser parser;
+	if (isStreamHeader( indexfile.begin(), indexfile.end()))
+	{
+		bzip2Decompress( indexfile.begin(), indexfile.size(), ChunkSize, parser);
+	}
+	else
+	{
+		std::string content( indexfile.begin(), indexfile.size());
+		parser.push( content, true);
+	}
+	std::sort( parser.offsets.begin(), parser.offsets.end());
+	if (parser.offsets.empty() || parser.offsets[0] != 0)
+	{
+		m_offsets.push_back( m_file.begin());
+		//... the first stream (siteinfo) is not referenced in the index
+	}
+	std::vector<std::size_t>::const_iterator oi = parser.offsets.begin(), oe = parser.offsets.end();
+	for (; oi != oe; ++oi)
+	{
+		if (*oi >= m_file.size()) throw std::runtime_error( "bzip2 multistream index file does not match the input file (offset out of range)");
+		if (!isStreamHeader( m_file.begin() + *oi, m_file.end()))
+		{
+			throw std::runtime_error( strus::string_format( "bzip2 multistream index file does not match the input file (no stream at offset %lu)", (unsigned long)*oi));
+		}
+		m_offsets.push_back( m_file.begin() + *oi);
+	}
+}
+
+Bzip2MultistreamInput::Bzip2MultistreamInput( const std::string& path, const std::string& indexpath, int nofThreads, std::size_t minSegmentSize)
+	:m_file(path),m_minSegmentSize(minSegmentSize ? minSegmentSize : 1),m_offsets(),m_offsetidx(0),m_scanpos(m_file.begin())
+	,m_nofSegments(0),m_threads(),m_mutex(),m_cv_ready(),m_cv_consumed()
+	,m_chunks(),m_bufferedSize(0),m_eof(false),m_terminate(false)
+	,m_chunkkey(0,0),m_chunk(),m_chunkpos(0)
+{
+	if (m_file.size() && !isStreamHeader( m_file.begin(), m_file.end()))
+	{
+		throw std::runtime_error( strus::string_format( "input file '%s' is not a bzip2 file", path.c_str()));
+	}
+	if (!indexpath.empty())
+	{
+		loadIndex( indexpath);
+	}
+	if (nofThreads <= 0) nofThreads = 1;
+	try
+	{
+		for (int ti=0; ti < nofThreads; ++ti)
+		{
+			m_threads.push_back( new strus::thread( &Bzip2MultistreamInput::run, this));
+		}
+	}
+	catch (...)
+	{
+		stopThreads();
+		throw;
+	}
+}
+
+Bzip2MultistreamInput::~Bzip2MultistreamInput()
+{
+	stopThreads();
+}
+
+void Bzip2MultistreamInput::stopThreads()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+		m_cv_consumed.notify_all();
+		m_cv_ready.notify_all();
+	}
+	std::vector<strus::thread*>::iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		(*ti)->join();
+		delete *ti;
+	}
+	m_threads.clear();
+}
+
+bool Bzip2MultistreamInput::fetchSegment( const char*& segstart, std::size_t& segsize, int& segidx)
+{
+	if (m_scanpos >= m_file.end())
+	{
+		m_eof = true;
+		return false;
+	}
+	const char* segend;
+	if (m_offsets.empty())
+	{
+		segend = findStreamHeader( m_scanpos + std::min( m_minSegmentSize, (std::size_t)(m_file.end() - m_scanpos)), m_file.end());
+	}
+	else
+	{
+		while (m_offsetidx < m_offsets.size() && (std::size_t)(m_offsets[ m_offsetidx] - m_scanpos) < m_minSegmentSize) ++m_offsetidx;
+		segend = (m_offsetidx < m_offsets.size()) ? m_offsets[ m_offsetidx] : m_file.end();
+	}
+	segstart = m_scanpos;
+	segsize = segend - m_scanpos;
+	segidx = m_nofSegments++;
+	m_scanpos = segend;
+	return true;
+}
+
+namespace strus {
+/// \brief Sink for bzip2Decompress delivering the decompressed pieces of a segment as chunks
+struct Bzip2ChunkSink
+{
+	Bzip2ChunkSink( Bzip2MultistreamInput* input_, int segidx_)
+		:input(input_),segidx(segidx_),partidx(0){}
+
+	void push( std::string& piece, bool last)
+	{
+		Bzip2MultistreamInput::Chunk chunk;
+		chunk.data.swap( piece);
+		chunk.last = last;
+		input->deliverChunk( Bzip2MultistreamInput::ChunkKey( segidx, partidx++), chunk);
+	}
+
+	Bzip2MultistreamInput* input;
+	int segidx;
+	int partidx;
+};
+}//namespace
+
+void Bzip2MultistreamInput::deliverChunk( const ChunkKey& key, Chunk& chunk)
+{
+	strus::unique_lock lock( m_mutex);
+	while (!m_terminate && key.first != m_chunkkey.first && m_bufferedSize > MaxBufferedSize)
+	{
+		//... never block the segment currently read, otherwise the reader could wait forever
+		m_cv_consumed.wait( lock);
+	}
+	m_bufferedSize += chunk.data.size();
+	Chunk& dest = m_chunks[ key];
+	dest.data.swap( chunk.data);
+	dest.error.swap( chunk.error);
+	dest.last = chunk.last;
+	m_cv_ready.notify_all();
+}
+
+void Bzip2MultistreamInput::decompressSegment( const char* segstart, std::size_t segsize, int segidx)
+{
+	Bzip2ChunkSink sink( this, segidx);
+	try
+	{
+		bzip2Decompress( segstart, segsize, ChunkSize, sink);
+	}
+	catch (const std::bad_alloc&)
+	{
+		Chunk chunk;
+		chunk.error = "out of memory decompressing bzip2 input";
+		chunk.last = true;
+		deliverChunk( ChunkKey( segidx, sink.partidx), chunk);
+	}
+	catch (const std::runtime_error& err)
+	{
+		Chunk chunk;
+		chunk.error = strus::string_format( "%s (in segment at offset %lu)", err.what(), (unsigned long)(segstart - m_file.begin()));
+		chunk.last = true;
+		deliverChunk( ChunkKey( segidx, sink.partidx), chunk);
+	}
+}
+
+void Bzip2MultistreamInput::run()
+{
+	for (;;)
+	{
+		const char* segstart;
+		std::size_t segsize;
+		int segidx;
+		{
+			strus::unique_lock lock( m_mutex);
+			if (m_terminate || !fetchSegment( segstart, segsize, segidx))
+			{
+				m_cv_ready.notify_all();
+				return;
+			}
+		}
+		decompressSegment( segstart, segsize, segidx);
+	}
+}
+
+std::size_t Bzip2MultistreamInput::read( void* buf, std::size_t bufsize)
+{
+	std::size_t rt = 0;
+	while (rt < bufsize)
+	{
+		if (m_chunkpos < m_chunk.data.size())
+		{
+			std::size_t nn = std::min( bufsize - rt, m_chunk.data.size() - m_chunkpos);
+			std::memcpy( (char*)buf + rt, m_chunk.data.c_str() + m_chunkpos, nn);
+			m_chunkpos += nn;
+			rt += nn;
+			continue;
+		}
+		strus::unique_lock lock( m_mutex);
+		std::map<ChunkKey,Chunk>::iterator ci = m_chunks.find( m_chunkkey);
+		while (ci == m_chunks.end())
+		{
+			if (m_eof && m_chunkkey.first >= m_nofSegments) return rt;
+			m_cv_ready.wait( lock);
+			ci = m_chunks.find( m_chunkkey);
+		}
+		m_bufferedSize -= ci->second.data.size();
+		m_chunk.data.swap( ci->second.data);
+		m_chunk.error.swap( ci->second.error);
+		m_chunk.last = ci->second.last;
+		m_chunkpos = 0;
+		m_chunks.erase( ci);
+		m_chunkkey = m_chunk.last ? ChunkKey( m_chunkkey.first+1, 0) : ChunkKey( m_chunkkey.first, m_chunkkey.second+1);
+		m_cv_consumed.notify_all();
+
+		if (!m_chunk.error.empty()) throw std::runtime_error( m_chunk.error);
+	}
+	return rt;
+}
+
+int Bzip2MultistreamInput::errorcode() const
+{
+	return 0;
+	//... errors are reported as exceptions
+}
+
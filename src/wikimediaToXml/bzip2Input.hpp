@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Input stream decompressing a bzip2 multistream file with a pool of threads
+/// \file bzip2Input.hpp
+#ifndef _STRUS_WIKIPEDIA_BZIP2_INPUT_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_BZIP2_INPUT_HPP_INCLUDED
+#include "textwolf/istreamiterator.hpp"
+#include "mappedFile.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Input stream decompressing a bzip2 file with a pool of threads
+/// \remark Wikipedia multistream dumps are a concatenation of independent bzip2 streams (100 pages each).
+///	The streams are either located with help of the multistream index file (lines "<offset>:<pageid>:<title>")
+///	or by searching for the bzip2 stream header magic. Groups of streams (segments) are decompressed in parallel
+///	and delivered in the original order. A file with a single stream is decompressed by one thread.
+class Bzip2MultistreamInput
+	:public textwolf::IStream
+{
+public:
+	enum {DefaultMinSegmentSize=(1<<18)};	///< default minimum compressed size of a group of streams decompressed as one job
+
+	/// \brief Constructor
+	/// \param[in] path path of the compressed input file (stdin not supported)
+	/// \param[in] indexpath path of the multistream index file (plain or bzip2 compressed) or empty if the stream offsets should be searched
+	/// \param[in] nofThreads number of decompression threads
+	/// \param[in] minSegmentSize minimum compressed size of a group of streams decompressed as one job
+	Bzip2MultistreamInput( const std::string& path, const std::string& indexpath, int nofThreads, std::size_t minSegmentSize=DefaultMinSegmentSize);
+	virtual ~Bzip2MultistreamInput();
+
+	virtual std::size_t read( void* buf, std::size_t bufsize);
+	virtual int errorcode() const;
+
+private:
+	typedef std::pair<int,int> ChunkKey;		//... (segment index, part index)
+	struct Chunk
+	{
+		std::string data;
+		std::string error;
+		bool last;				//... last part of a segment
+
+		Chunk()
+			:data(),error(),last(false){}
+	};
+
+	void loadIndex( const std::string& indexpath);
+	bool fetchSegment( const char*& segstart, std::size_t& segsize, int& segidx);
+	void decompressSegment( const char* segstart, std::size_t segsize, int segidx);
+	void deliverChunk( const ChunkKey& key, Chunk& chunk);
+	void run();
+	void stopThreads();
+
+	friend struct Bzip2ChunkSink;
+
+private:
+	enum {
+		ChunkSize=(1<<22),			//... maximum decompressed size of a chunk delivered
+		MaxBufferedSize=(1<<26)			//... maximum size of chunks buffered ahead of the reader
+	};
+
+	MappedFile m_file;
+	std::size_t m_minSegmentSize;			//... minimum compressed size of a group of streams decompressed as one job
+	std::vector<const char*> m_offsets;		//... stream offsets from the index file, empty if searched
+	std::size_t m_offsetidx;
+	const char* m_scanpos;				//... start of next segment
+	int m_nofSegments;				//... number of segments fetched for decompression
+	std::vector<strus::thread*> m_threads;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cv_ready;		//... signaled when a chunk has been decompressed
+	strus::condition_variable m_cv_consumed;	//... signaled when a chunk has been consumed
+	std::map<ChunkKey,Chunk> m_chunks;		//... decompressed chunks not yet consumed
+	std::size_t m_bufferedSize;			//... sum of sizes of chunks in m_chunks
+	bool m_eof;					//... all segments have been fetched
+	bool m_terminate;
+	ChunkKey m_chunkkey;				//... key of the next chunk to read
+	Chunk m_chunk;					//... chunk currently read
+	std::size_t m_chunkpos;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Checkpoints of a conversion run for resuming it after an interruption
+/// \file checkpoint.cpp
+#include "checkpoint.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/numstring.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <limits>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+using namespace strus;
+
+Checkpoint::Checkpoint( const std::string& filename_, int interval_)
+	:m_mutex(),m_filename(filename_),m_interval(interval_),m_tickCounter(0)
+	,m_startOffset(0),m_startDocno(0),m_completedBefore()
+	,m_dispatched(),m_completed(),m_watermark(0),m_lastDocno(-1),m_lastOffset(0)
+{}
+
+bool Checkpoint::load()
+{
+	std::string content;
+	int ec = strus::readFile( m_filename, content);
+	if (ec == ENOENT) return false;
+	if (ec) throw std::runtime_error( strus::string_format( "failed to read checkpoint file '%s': %s", m_filename.c_str(), ::strerror(ec)));
+
+	bool hasOffset = false;
+	bool hasDocno = false;
+	std::istringstream input( content);
+	std::string line;
+	while (std::getline( input, line))
+	{
+		if (line.empty()) continue;
+		std::string::size_type sep = line.find( ' ');
+		if (sep == std::string::npos) throw std::runtime_error( strus::string_format( "syntax error in checkpoint file '%s': '%s'", m_filename.c_str(), line.c_str()));
+		std::string key( line, 0, sep);
+		std::string value( line, sep+1);
+		if (key == "offset")
+		{
+			m_startOffset = strus::numstring_conv::touint( value, std::numeric_limits<textwolf::PositionIndex>::max());
+			hasOffset = true;
+		}
+		else if (key == "docno")
+		{
+			m_startDocno = strus::numstring_conv::touint( value, std::numeric_limits<int>::max());
+			hasDocno = true;
+		}
+		else if (key == "completed")
+		{
+			m_completedBefore.insert( strus::numstring_conv::touint( value, std::numeric_limits<int>::max()));
+		}
+		else
+		{
+			throw std::runtime_error( strus::string_format( "unknown item '%s' in checkpoint file '%s'", key.c_str(), m_filename.c_str()));
+		}
+	}
+	if (!hasOffset || !hasDocno) throw std::runtime_error( strus::string_format( "incomplete checkpoint file '%s'", m_filename.c_str()));
+	m_watermark = m_startDocno;
+	return true;
+}
+
+void Checkpoint::dispatched( int docno, textwolf::PositionIndex offset)
+{
+	strus::unique_lock lock( m_mutex);
+	m_dispatched[ docno] = offset;
+}
+
+void Checkpoint::completed( int docno)
+{
+	strus::unique_lock lock( m_mutex);
+	m_completed.insert( docno);
+	std::set<int>::iterator ci = m_completed.begin();
+	while (ci != m_completed.end() && *ci == m_watermark)
+	{
+		std::map<int,textwolf::PositionIndex>::iterator di = m_dispatched.find( m_watermark);
+		if (di != m_dispatched.end())
+		{
+			m_lastDocno = m_watermark;
+			m_lastOffset = di->second;
+			m_dispatched.erase( di);
+		}
+		m_completed.erase( ci++);
+		++m_watermark;
+	}
+}
+
+void Checkpoint::tick()
+{
+	if (++m_tickCounter >= m_interval)
+	{
+		m_tickCounter = 0;
+		write();
+	}
+}
+
+void Checkpoint::write()
+{
+	std::ostringstream out;
+	{
+		strus::unique_lock lock( m_mutex);
+		std::set<int> completedSet;
+		int docno;
+		if (m_dispatched.find( m_watermark) != m_dispatched.end())
+		{
+			docno = m_watermark;
+			out << "offset " << m_dispatched[ m_watermark] << "\n";
+			completedSet = m_completed;
+		}
+		else if (m_lastDocno >= 0)
+		{
+			//... all documents dispatched are completed, restart with the last one and mark it as completed
+			docno = m_lastDocno;
+			out << "offset " << m_lastOffset << "\n";
+			completedSet = m_completed;
+			completedSet.insert( m_lastDocno);
+		}
+		else
+		{
+			docno = m_startDocno;
+			out << "offset " << m_startOffset << "\n";
+		}
+		out << "docno " << docno << "\n";
+		std::set<int>::const_iterator bi = m_completedBefore.lower_bound( docno), be = m_completedBefore.end();
+		for (; bi != be; ++bi) completedSet.insert( *bi);
+		//... documents completed by the previous run not seen yet by this one
+
+		std::set<int>::const_iterator ci = completedSet.begin(), ce = completedSet.end();
+		for (; ci != ce; ++ci) out << "completed " << *ci << "\n";
+	}
+	std::string tmpfilename = m_filename + ".tmp";
+	int ec = strus::writeFile( tmpfilename, out.str());
+	if (ec) throw std::runtime_error( strus::string_format( "failed to write checkpoint file '%s': %s", tmpfilename.c_str(), ::strerror(ec)));
+	if (0 != std::rename( tmpfilename.c_str(), m_filename.c_str()))
+	{
+		ec = errno;
+		throw std::runtime_error( strus::string_format( "failed to rename checkpoint file '%s': %s", tmpfilename.c_str(), ::strerror(ec)));
+	}
+	//... replacing the checkpoint file by renaming, a run killed while writing leaves the previous checkpoint intact
+}
+
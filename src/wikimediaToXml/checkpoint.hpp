@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Checkpoints of a conversion run for resuming it after an interruption
+/// \file checkpoint.hpp
+#ifndef _STRUS_WIKIPEDIA_CHECKPOINT_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_CHECKPOINT_HPP_INCLUDED
+#include "textwolf/position.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <map>
+#include <set>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Tracks the documents dispatched and completed and writes checkpoints for resuming an interrupted run
+/// \remark A checkpoint stores the input offset of the page of the first document not completed (or of the last document if all are completed),
+///	its document number and the set of document numbers above it completed already (workers finish documents out of order).
+///	A resumed run starts scanning at the checkpoint offset with the checkpoint document number and skips the documents completed.
+class Checkpoint
+{
+public:
+	/// \brief Constructor
+	/// \param[in] filename_ name of the checkpoint file
+	/// \param[in] interval_ number of documents dispatched between two checkpoints written
+	Checkpoint( const std::string& filename_, int interval_);
+
+	/// \brief Load the checkpoint written by a previous run
+	/// \return false if the checkpoint file does not exist, throws on error
+	bool load();
+
+	/// \brief Input offset of the page to start scanning with
+	textwolf::PositionIndex startOffset() const		{return m_startOffset;}
+	/// \brief Document number of the first document to start scanning with
+	int startDocno() const					{return m_startDocno;}
+	/// \brief Evaluate if a document has been completed by a previous run (loaded checkpoint)
+	bool completedBefore( int docno) const			{return m_completedBefore.find( docno) != m_completedBefore.end();}
+
+	/// \brief Notify that a document has been dispatched for processing, called in ascending order of document numbers
+	/// \param[in] docno document number
+	/// \param[in] offset input offset of the page of the document
+	void dispatched( int docno, textwolf::PositionIndex offset);
+	/// \brief Notify that a document has been completed
+	/// \param[in] docno document number
+	void completed( int docno);
+
+	/// \brief Write a checkpoint, if the interval of documents dispatched since the last checkpoint has been reached
+	void tick();
+	/// \brief Write a checkpoint with the current state
+	void write();
+
+private:
+	strus::mutex m_mutex;
+	std::string m_filename;
+	int m_interval;
+	int m_tickCounter;
+	textwolf::PositionIndex m_startOffset;
+	int m_startDocno;
+	std::set<int> m_completedBefore;			//... documents completed by a previous run
+	std::map<int,textwolf::PositionIndex> m_dispatched;	//... documents dispatched with a number >= m_watermark
+	std::set<int> m_completed;				//... documents completed with a number > m_watermark
+	int m_watermark;					//... all documents with a smaller number are completed
+	int m_lastDocno;					//... last document below the watermark
+	textwolf::PositionIndex m_lastOffset;			//... offset of last document below the watermark
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Binding threads to CPUs and querying the NUMA node of a CPU
+/// \file cpuAffinity.cpp
+#include "cpuAffinity.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace strus;
+
+enum {MaxNumaNodes=256};
+
+static int parseCpuNumber( char const*& si, const std::string& src)
+{
+	if (*si < '0' || *si > '9') throw std::runtime_error( strus::string_format( "CPU number expected in CPU list '%s'", src.c_str()));
+	int rt = 0;
+	for (; *si >= '0' && *si <= '9'; ++si)
+	{
+		rt = rt * 10 + (*si - '0');
+		if (rt >= (1<<16)) throw std::runtime_error( strus::string_format( "CPU number out of range in CPU list '%s'", src.c_str()));
+	}
+	return rt;
+}
+
+std::vector<int> strus::parseCpuList( const std::string& src)
+{
+	std::vector<int> rt;
+	char const* si = src.c_str();
+	for (;;)
+	{
+		int first = parseCpuNumber( si, src);
+		int last = first;
+		if (*si == '-')
+		{
+			++si;
+			last = parseCpuNumber( si, src);
+			if (last < first) throw std::runtime_error( strus::string_format( "invalid range in CPU list '%s'", src.c_str()));
+		}
+		for (int cpu=first; cpu <= last; ++cpu) rt.push_back( cpu);
+		if (!*si) break;
+		if (*si != ',') throw std::runtime_error( strus::string_format( "unexpected character '%c' in CPU list '%s'", *si, src.c_str()));
+		++si;
+	}
+	return rt;
+}
+
+bool strus::isCpuAvailable( int cpu)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO( &set);
+	if (cpu < 0 || cpu >= CPU_SETSIZE || 0 != ::sched_getaffinity( 0, sizeof(set), &set)) return false;
+	return CPU_ISSET( cpu, &set);
+#else
+	return cpu >= 0 && cpu < ::sysconf( _SC_NPROCESSORS_CONF);
+#endif
+}
+
+int strus::getCpuNumaNode( int cpu)
+{
+	//... the sysfs directory of a node contains a link to each of its CPUs
+	char path[ 128];
+	for (int node=0; node < MaxNumaNodes; ++node)
+	{
+		std::snprintf( path, sizeof(path), "/sys/devices/system/node/node%d/cpu%d", node, cpu);
+		if (0 == ::access( path, F_OK)) return node;
+	}
+	return -1;
+}
+
+int strus::bindThreadToCpu( int cpu)
+{
+#if defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE) return EINVAL;
+	cpu_set_t set;
+	CPU_ZERO( &set);
+	CPU_SET( cpu, &set);
+	//... pid 0 refers to the calling thread
+	if (0 != ::sched_setaffinity( 0, sizeof(set), &set)) return errno;
+	return 0;
+#else
+	return ENOSYS;
+#endif
+}
+
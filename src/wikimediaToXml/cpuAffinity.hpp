@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Binding threads to CPUs and querying the NUMA node of a CPU
+/// \file cpuAffinity.hpp
+#ifndef _STRUS_WIKIPEDIA_CPU_AFFINITY_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_CPU_AFFINITY_HPP_INCLUDED
+#include <string>
+#include <vector>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Parse a list of CPU numbers and ranges, e.g. "0-3,8,10-11", throws on syntax errors
+/// \param[in] src list to parse
+/// \return the CPU numbers in the order of the list
+std::vector<int> parseCpuList( const std::string& src);
+
+/// \brief Check if the process is allowed to run on a CPU
+/// \param[in] cpu number of the CPU
+bool isCpuAvailable( int cpu);
+
+/// \brief Get the NUMA node of a CPU
+/// \param[in] cpu number of the CPU
+/// \return the number of the node or -1 if not known (no NUMA information available)
+int getCpuNumaNode( int cpu);
+
+/// \brief Bind the calling thread to a CPU
+/// \param[in] cpu number of the CPU
+/// \return 0 on success, else an error code (errno)
+/// \note Memory allocated and first written by a bound thread is placed on the NUMA node of its CPU by the default policy of the OS
+int bindThreadToCpu( int cpu);
+
+}//namespace
+#endif
+
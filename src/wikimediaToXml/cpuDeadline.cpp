@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Limit of the CPU time spent by a thread for a task, polled in the loops of the conversion
+/// \file cpuDeadline.cpp
+#include "cpuDeadline.hpp"
+#include "monotonicClock.hpp"
+#include "strus/base/string_format.hpp"
+#include <time.h>
+
+using namespace strus;
+
+CpuDeadline::CpuDeadline( int limitMs_)
+	:m_limitMs(limitMs_),m_deadline(limitMs_ ? threadCpuTimeSeconds() + limitMs_ / 1000.0 : 0.0),m_pollCounter(0){}
+
+void CpuDeadline::check()
+{
+	if (m_limitMs && threadCpuTimeSeconds() > m_deadline)
+	{
+		throw CpuDeadlineExceededException( strus::string_format( "conversion aborted after exceeding the CPU time limit of %d ms", m_limitMs));
+	}
+}
+
+double CpuDeadline::threadCpuTimeSeconds()
+{
+	struct timespec ts;
+	if (0 != ::clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts))
+	{
+		//... no thread CPU clock, use the elapsed time
+		return strus::monotonicTimeSeconds();
+	}
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
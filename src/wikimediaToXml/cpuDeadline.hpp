@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Limit of the CPU time spent by a thread for a task, polled in the loops of the conversion
+/// \file cpuDeadline.hpp
+#ifndef _STRUS_WIKIPEDIA_CPU_DEADLINE_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_CPU_DEADLINE_HPP_INCLUDED
+#include <stdexcept>
+#include <string>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Exception thrown when a task exceeds its CPU time limit
+class CpuDeadlineExceededException
+	:public std::runtime_error
+{
+public:
+	explicit CpuDeadlineExceededException( const std::string& msg)
+		:std::runtime_error(msg){}
+};
+
+/// \brief Deadline in CPU time of the calling thread for a task
+/// \remark The thread CPU clock is not for free, it is read only every CheckInterval calls of poll, so poll can be called in inner loops
+class CpuDeadline
+{
+public:
+	enum {CheckInterval=1024};
+
+	/// \brief Constructor
+	/// \param[in] limitMs_ limit of the CPU time in milliseconds from now or 0 for no limit
+	explicit CpuDeadline( int limitMs_);
+
+	/// \brief Poll the deadline
+	/// \remark throws CpuDeadlineExceededException if the CPU time limit is exceeded
+	void poll()
+	{
+		if (m_limitMs && ++m_pollCounter % CheckInterval == 0) check();
+	}
+	/// \brief Check the deadline now
+	/// \remark throws CpuDeadlineExceededException if the CPU time limit is exceeded
+	void check();
+
+	/// \brief Get the limit of the CPU time in milliseconds or 0 if there is no limit
+	int limitMs() const			{return m_limitMs;}
+
+	/// \brief Get the CPU time consumed by the calling thread in seconds
+	static double threadCpuTimeSeconds();
+
+private:
+	int m_limitMs;
+	double m_deadline;
+	unsigned int m_pollCounter;
+};
+
+}//namespace
+#endif
+
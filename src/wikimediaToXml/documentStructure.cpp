@@ -22,6 +22,7 @@
 #include <iostream>
 #include <sstream>
 #include <set>
+#include <cstring>
 
 typedef textwolf::XMLPrinter<textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlPrinterBase;
 
@@ -138,6 +139,7 @@ void DocumentStructure::checkStartEndSectionBalance( const std::vector<Paragraph
 	std::vector<Paragraph>::const_iterator ii = start;
 	for (; ii != end; ++ii)
 	{
+		pollDeadline();
 		switch (ii->type())
 		{
 			case Paragraph::QuotationStart:
@@ -224,6 +226,7 @@ void DocumentStructure::closeDanglingStructures( const Paragraph::Type& starttyp
 {
 	while (!m_structStack.empty())
 	{
+		pollDeadline();
 		int startidx = m_structStack.back().start;
 		Paragraph para = m_parar[ startidx];
 		if (para.type() == starttype)
@@ -583,6 +586,7 @@ void DocumentStructure::finishTable( int startidx, const std::string& tableid)
 		std::vector<Paragraph>::const_iterator hi = m_parar.begin() + startidx + 1, he = m_parar.end();
 		for (int hidx=startidx + 1; hi != he; ++hi,++hidx)
 		{
+			pollDeadline();
 			if (hi->type() == types[ ti])
 			{
 				m_tables.push_back( *hi);
@@ -1365,6 +1369,14 @@ static bool isSpaceOnlyText( const std::string& text)
 	return !*si;
 }
 
+static bool isSpaceOnlyText( const char* text, std::size_t textsize)
+{
+	char const* si = text;
+	const char* se = text + textsize;
+	for (; si != se && *si && (unsigned char)*si <= 32; ++si){}
+	return si == se || !*si;
+}
+
 void DocumentStructure::clearOpenText()
 {
 	if (!m_parar.empty() && m_parar.back().type() == Paragraph::Text)
@@ -1456,12 +1468,53 @@ void DocumentStructure::addSingleItem( Paragraph::Type type, const std::string&
 	}
 }
 
+void DocumentStructure::addText( const char* text, std::size_t textsize)
+{
+	//... same as addSingleItem( Paragraph::Text, "", text, true), but the text is only copied into the paragraph it is added to
+	if (!m_parar.empty() && m_parar.back().type() == Paragraph::AttributeStart)
+	{
+		m_parar.back().addText( text, textsize);
+	}
+	else if (!m_parar.empty() && m_parar.back().type() == Paragraph::Text)
+	{
+		if (!isSpaceOnlyText( text, textsize))
+		{
+			m_parar.back().addText( text, textsize);
+		}
+		else if (textsize)
+		{
+			m_parar.back().addText( 0!=std::memchr( text, '\n', textsize) ? "\n" : " ");
+		}
+	}
+	else if (m_parar.size() >= 2
+	&&	(	isLastItemJoinableText( m_parar, Paragraph::PageLinkStart, Paragraph::PageLinkEnd)
+		||	isLastItemJoinableText( m_parar, Paragraph::WebLinkStart, Paragraph::WebLinkEnd)
+		||	isLastItemJoinableText( m_parar, Paragraph::QuotationStart, Paragraph::QuotationEnd)
+		||	isLastItemJoinableText( m_parar, Paragraph::MultiQuoteStart, Paragraph::MultiQuoteEnd)
+		))
+	{
+		//... text possibly joined with a link before, rare enough for a temporary copy
+		addSingleItem( Paragraph::Text, "", std::string( text, textsize), true/*joinText*/);
+	}
+	else
+	{
+		//... the empty paragraph is copied into the vector without allocating, the text is copied once
+		m_parar.push_back( Paragraph());
+		m_parar.back().addText( text, textsize);
+	}
+}
+
 void DocumentStructure::finish()
 {
 	closeOpenStructures();
 	checkStartEndSectionBalance( m_parar.begin(), m_parar.end());
 }
 
+std::string DocumentStructure::getFileId( const std::string& title)
+{
+	return getFileIdFromTitle( title);
+}
+
 std::string DocumentStructure::getInputXML( const std::string& title, const std::string& content)
 {
 	std::string rt;
@@ -1659,6 +1712,7 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 	std::vector<Paragraph>::const_iterator pi = m_parar.begin(), pe = m_parar.end();
 	for(int pidx=0; pi != pe; ++pi,++pidx)
 	{
+		pollDeadline();
 		if (beautified && !output.isInTagDeclaration())
 		{
 			output.printValue( std::string("\n") + std::string( 2*stk.size(), ' '), rt);
@@ -12,6 +12,7 @@
 #define _STRUS_WIKIPEDIA_DOCUMENT_STRUCTURE_HPP_INCLUDED
 #include "strus/base/string_format.hpp"
 #include "strus/base/fileio.hpp"
+#include "cpuDeadline.hpp"
 #include <string>
 #include <map>
 #include <set>
@@ -317,6 +318,10 @@ public:
 	{
 		m_text += text_;
 	}
+	void addText( const char* text_, std::size_t textsize_)
+	{
+		m_text.append( text_, textsize_);
+	}
 	std::string tokey() const
 	{
 		return strus::string_format( "%d\1%s\1%s", (int)m_type, m_id.c_str(), m_text.c_str());
@@ -335,12 +340,12 @@ public:
 		:m_fileId(),m_parar(),m_citations(),m_tables(),m_refs(),m_citationmap()
 		,m_refmap(),m_structStack(),m_tableDefs(),m_errors(),m_unresolved()
 		,m_nofErrors(0),m_tableCnt(0),m_citationCnt(0),m_refCnt(0)
-		,m_lastHeadingIdx(0),m_maxStructureDepthReported(false){}
+		,m_lastHeadingIdx(0),m_maxStructureDepthReported(false),m_deadline(0){}
 	DocumentStructure( const DocumentStructure& o)
 		:m_fileId(o.m_fileId),m_parar(o.m_parar),m_citations(o.m_citations),m_tables(o.m_tables),m_refs(o.m_refs),m_citationmap(o.m_citationmap)
 		,m_refmap(o.m_refmap),m_structStack(o.m_structStack),m_tableDefs(o.m_tableDefs),m_errors(o.m_errors),m_unresolved(o.m_unresolved)
 		,m_nofErrors(o.m_nofErrors),m_tableCnt(o.m_tableCnt),m_citationCnt(o.m_citationCnt),m_refCnt(o.m_refCnt)
-		,m_lastHeadingIdx(o.m_lastHeadingIdx),m_maxStructureDepthReported(o.m_maxStructureDepthReported){}
+		,m_lastHeadingIdx(o.m_lastHeadingIdx),m_maxStructureDepthReported(o.m_maxStructureDepthReported),m_deadline(o.m_deadline){}
 
 	const std::string& fileId() const
 	{
@@ -350,6 +355,12 @@ public:
 	int currentStructIndex() const;
 
 	void setTitle( const std::string& text);
+	/// \brief Set the CPU time limit polled in the loops building the structure and printing it
+	/// \param[in] deadline_ deadline (with ownership kept by the caller) or NULL for no limit
+	void setDeadline( CpuDeadline* deadline_)
+	{
+		m_deadline = deadline_;
+	}
 
 	void addMarkup( const std::string& text)
 	{
@@ -360,6 +371,8 @@ public:
 	{
 		addSingleItem( Paragraph::Text, "", text, true/*joinText*/);
 	}
+	/// \brief Add text referenced in the source, only copied where it is retained
+	void addText( const char* text, std::size_t textsize);
 	void addChar( const std::string& text)
 	{
 		addSingleItem( Paragraph::Char, "", text, false/*joinText*/);
@@ -652,6 +665,10 @@ public:
 	{
 		return std::vector<std::string>( m_unresolved.begin(), m_unresolved.end());
 	}
+	std::size_t nofParagraphs() const
+	{
+		return m_parar.size();
+	}
 	void finish();
 
 	std::string toxml( bool beautified, bool singleIdAttribute) const;
@@ -660,6 +677,8 @@ public:
 	std::string statestring() const;
 
 	static std::string getInputXML( const std::string& title, const std::string& content);
+	/// \brief Get the file id (base of the output file names) of a document with a title
+	static std::string getFileId( const std::string& title);
 
 private:
 	enum {MaxStructureDepth=12};
@@ -755,6 +774,11 @@ private:
 		}
 	};
 
+	void pollDeadline() const
+	{
+		if (m_deadline) m_deadline->poll();
+	}
+
 private:
 	std::string m_fileId;
 	std::vector<Paragraph> m_parar;
@@ -773,6 +797,7 @@ private:
 	int m_refCnt;
 	int m_lastHeadingIdx;
 	bool m_maxStructureDepthReported;
+	CpuDeadline* m_deadline;
 };
 
 
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Manifest of the documents converted for an incremental conversion of the next dump
+/// \file manifest.cpp
+#include "manifest.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <vector>
+#include <cstring>
+
+using namespace strus;
+
+const char* Manifest::statusName( Status status)
+{
+	static const char* ar[] = {"new","changed","unchanged","deleted"};
+	return ar[ status];
+}
+
+void Manifest::loadPrevious( const std::string& filename)
+{
+	std::string content;
+	int ec = strus::readFile( filename, content);
+	if (ec) throw std::runtime_error( strus::string_format( "failed to read manifest file '%s': %s", filename.c_str(), ::strerror(ec)));
+
+	int linecnt = 0;
+	char const* si = content.c_str();
+	const char* se = si + content.size();
+	while (si < se)
+	{
+		++linecnt;
+		const char* eoln = (const char*)std::memchr( si, '\n', se - si);
+		if (!eoln) eoln = se;
+		if (eoln > si)
+		{
+			std::vector<std::string> fields;
+			const char* fi = si;
+			for (;;)
+			{
+				const char* tab = (const char*)std::memchr( fi, '\t', eoln - fi);
+				if (!tab)
+				{
+					fields.push_back( std::string( fi, eoln - fi));
+					break;
+				}
+				fields.push_back( std::string( fi, tab - fi));
+				fi = tab + 1;
+			}
+			if (fields.size() != 5)
+			{
+				throw std::runtime_error( strus::string_format( "syntax error in manifest file '%s' on line %d: expected 5 fields", filename.c_str(), linecnt));
+			}
+			if (fields[0] != statusName( Deleted))
+			{
+				m_previous[ fields[1]] = Entry( fields[2], fields[3], fields[4]);
+			}
+		}
+		si = eoln + 1;
+	}
+}
+
+Manifest::Status Manifest::status( const std::string& title, const std::string& revision_id, const std::string& sha1) const
+{
+	EntryMap::const_iterator pi = m_previous.find( title);
+	if (pi == m_previous.end()) return New;
+	if (!sha1.empty() && !pi->second.sha1.empty())
+	{
+		return sha1 == pi->second.sha1 ? Unchanged : Changed;
+	}
+	if (!revision_id.empty() && !pi->second.revision_id.empty())
+	{
+		return revision_id == pi->second.revision_id ? Unchanged : Changed;
+	}
+	return Changed;
+}
+
+Manifest::Status Manifest::add( const std::string& title, const std::string& revision_id, const std::string& sha1, const std::string& filename)
+{
+	Status st = status( title, revision_id, sha1);
+	EntryMap::iterator pi = m_previous.find( title);
+	if (st == Unchanged)
+	{
+		++m_nofUnchanged;
+		appendLine( st, title, revision_id, sha1, pi->second.filename);
+	}
+	else
+	{
+		if (st == New) ++m_nofNew; else ++m_nofChanged;
+		appendLine( st, title, revision_id, sha1, filename);
+	}
+	if (pi != m_previous.end()) m_previous.erase( pi);
+	return st;
+}
+
+void Manifest::appendLine( Status status, const std::string& title, const std::string& revision_id, const std::string& sha1, const std::string& filename)
+{
+	m_content.append( statusName( status));
+	m_content.push_back( '\t');
+	m_content.append( title);
+	m_content.push_back( '\t');
+	m_content.append( revision_id);
+	m_content.push_back( '\t');
+	m_content.append( sha1);
+	m_content.push_back( '\t');
+	m_content.append( filename);
+	m_content.push_back( '\n');
+}
+
+void Manifest::write( const std::string& filename)
+{
+	EntryMap::const_iterator pi = m_previous.begin(), pe = m_previous.end();
+	for (; pi != pe; ++pi)
+	{
+		++m_nofDeleted;
+		appendLine( Deleted, pi->first, pi->second.revision_id, pi->second.sha1, pi->second.filename);
+	}
+	m_previous.clear();
+	int ec = strus::writeFile( filename, m_content);
+	if (ec) throw std::runtime_error( strus::string_format( "failed to write manifest file '%s': %s", filename.c_str(), ::strerror(ec)));
+}
+
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Manifest of the documents converted for an incremental conversion of the next dump
+/// \file manifest.hpp
+#ifndef _STRUS_WIKIPEDIA_MANIFEST_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_MANIFEST_HPP_INCLUDED
+#include <string>
+#include <map>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Manifest of the documents converted, mapping titles to the revision converted and the output file
+/// \remark The manifest file has one line per document with the tab separated fields status, title, revision id, revision sha1 and output file.
+///	The status is one of 'new', 'changed', 'unchanged' (document not converted again, the output file is the one of the run that converted it)
+///	and 'deleted' (document of the previous manifest not in the dump anymore, ignored when the manifest is loaded as previous manifest).
+class Manifest
+{
+public:
+	enum Status {New,Changed,Unchanged,Deleted};
+	static const char* statusName( Status status);
+
+	/// \brief Constructor
+	Manifest()
+		:m_previous(),m_content(),m_nofNew(0),m_nofChanged(0),m_nofUnchanged(0),m_nofDeleted(0){}
+
+	/// \brief Load the manifest of a previous run the documents are compared with
+	/// \param[in] filename name of the manifest file
+	void loadPrevious( const std::string& filename);
+
+	/// \brief Evaluate the status of a document compared with the previous manifest
+	/// \param[in] title title of the document
+	/// \param[in] revision_id id of the revision of the document
+	/// \param[in] sha1 sha1 of the revision of the document
+	/// \remark A document is considered as unchanged if the sha1 (or the revision id if a sha1 is missing) is equal
+	Status status( const std::string& title, const std::string& revision_id, const std::string& sha1) const;
+
+	/// \brief Add a document to the manifest of this run
+	/// \param[in] title title of the document
+	/// \param[in] revision_id id of the revision of the document
+	/// \param[in] sha1 sha1 of the revision of the document
+	/// \param[in] filename output file written for the document (ignored if the document is unchanged)
+	/// \return the status of the document compared with the previous manifest
+	Status add( const std::string& title, const std::string& revision_id, const std::string& sha1, const std::string& filename);
+
+	/// \brief Write the manifest of this run with the documents of the previous manifest not added marked as deleted
+	/// \param[in] filename name of the manifest file
+	void write( const std::string& filename);
+
+	int nofNew() const		{return m_nofNew;}
+	int nofChanged() const		{return m_nofChanged;}
+	int nofUnchanged() const	{return m_nofUnchanged;}
+	int nofDeleted() const		{return m_nofDeleted;}
+
+private:
+	void appendLine( Status status, const std::string& title, const std::string& revision_id, const std::string& sha1, const std::string& filename);
+
+private:
+	struct Entry
+	{
+		std::string revision_id;
+		std::string sha1;
+		std::string filename;
+
+		Entry()
+			:revision_id(),sha1(),filename(){}
+		Entry( const std::string& revision_id_, const std::string& sha1_, const std::string& filename_)
+			:revision_id(revision_id_),sha1(sha1_),filename(filename_){}
+		Entry( const Entry& o)
+			:revision_id(o.revision_id),sha1(o.sha1),filename(o.filename){}
+	};
+	typedef std::map<std::string,Entry> EntryMap;
+
+	EntryMap m_previous;		//... documents of the previous manifest not added yet
+	std::string m_content;		//... content of the manifest of this run
+	int m_nofNew;
+	int m_nofChanged;
+	int m_nofUnchanged;
+	int m_nofDeleted;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Read only memory mapped input file and an iterator on contiguous memory usable by textwolf
+/// \file mappedFile.cpp
+#include "mappedFile.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace strus;
+
+MappedFile::MappedFile( const std::string& path)
+	:m_ptr(0),m_size(0)
+{
+	if (path == "-") throw std::runtime_error( "standard input can not be memory mapped");
+
+	int fd = ::open( path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( "failed to open input file '%s': %s", path.c_str(), ::strerror(ec)));
+	}
+	struct stat st;
+	if (0 != ::fstat( fd, &st))
+	{
+		int ec = errno;
+		::close( fd);
+		throw std::runtime_error( strus::string_format( "failed to stat input file '%s': %s", path.c_str(), ::strerror(ec)));
+	}
+	if (!S_ISREG( st.st_mode))
+	{
+		::close( fd);
+		throw std::runtime_error( strus::string_format( "input file '%s' is not a regular file and can not be memory mapped", path.c_str()));
+	}
+	m_size = st.st_size;
+	if (m_size)
+	{
+		void* ptr = ::mmap( 0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr == MAP_FAILED)
+		{
+			int ec = errno;
+			::close( fd);
+			throw std::runtime_error( strus::string_format( "failed to map input file '%s': %s", path.c_str(), ::strerror(ec)));
+		}
+		(void)::madvise( ptr, m_size, MADV_SEQUENTIAL);
+		//... the dump is read once from start to end, let the kernel read ahead aggressively and drop pages already visited
+		m_ptr = (const char*)ptr;
+	}
+	::close( fd);
+	//... the mapping stays valid after closing the file descriptor
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_ptr) ::munmap( (void*)const_cast<char*>(m_ptr), m_size);
+}
+
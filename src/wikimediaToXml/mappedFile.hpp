@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Read only memory mapped input file and an iterator on contiguous memory usable by textwolf
+/// \file mappedFile.hpp
+#ifndef _STRUS_WIKIPEDIA_MAPPED_FILE_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_MAPPED_FILE_HPP_INCLUDED
+#include "textwolf/textscanner.hpp"
+#include "textwolf/position.hpp"
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Input file mapped read only into memory for sequential access
+class MappedFile
+{
+public:
+	/// \brief Constructor, throws on failure
+	/// \param[in] path path of the file to map (must be a regular file, stdin can not be mapped)
+	explicit MappedFile( const std::string& path);
+	~MappedFile();
+
+	const char* begin() const		{return m_ptr;}
+	const char* end() const			{return m_ptr + m_size;}
+	std::size_t size() const		{return m_size;}
+
+private:
+	MappedFile( const MappedFile&);		//... non copyable
+	void operator=( const MappedFile&);	//... non copyable
+
+private:
+	const char* m_ptr;
+	std::size_t m_size;
+};
+
+/// \brief Input iterator on contiguous memory returning null characters after the end as required by textwolf scanners
+/// \note Unlike textwolf::CStringIterator it is not restricted to 32 bit sizes
+class MemoryInputIterator
+{
+public:
+	MemoryInputIterator()
+		:m_itr(0),m_end(0),m_start(0){}
+	MemoryInputIterator( const char* begin_, const char* end_)
+		:m_itr(begin_),m_end(end_),m_start(begin_){}
+	MemoryInputIterator( const MemoryInputIterator& o)
+		:m_itr(o.m_itr),m_end(o.m_end),m_start(o.m_start){}
+
+	inline char operator* ()
+	{
+		return (m_itr < m_end) ? *m_itr : 0;
+	}
+
+	inline MemoryInputIterator& operator++()
+	{
+		++m_itr;
+		return *this;
+	}
+
+	inline int operator - (const MemoryInputIterator& o) const
+	{
+		return (int)(m_itr - o.m_itr);
+	}
+
+	/// \brief Byte position relative to the start of the iterated memory block
+	textwolf::PositionIndex position() const
+	{
+		return m_itr - m_start;
+	}
+
+	/// \brief Pointer to the current character
+	const char* ptr() const
+	{
+		return m_itr;
+	}
+
+private:
+	const char* m_itr;
+	const char* m_end;
+	const char* m_start;
+};
+
+}//namespace
+
+namespace textwolf {
+template <>
+struct Traits<strus::MemoryInputIterator>
+{
+	static inline std::size_t getPosition( const strus::MemoryInputIterator&, const strus::MemoryInputIterator& itr)
+	{
+		return itr.position();
+	}
+};
+}//namespace
+#endif
+
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Monotonic clock for measuring durations, not affected by changes of the system time
+/// \file monotonicClock.hpp
+#ifndef _STRUS_WIKIPEDIA_MONOTONIC_CLOCK_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_MONOTONIC_CLOCK_HPP_INCLUDED
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Current time of the monotonic clock in nanoseconds
+unsigned long long monotonicTimeNs();
+
+/// \brief Current time of the monotonic clock in seconds
+double monotonicTimeSeconds();
+
+}//namespace
+#endif
+
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Writing the output files of the conversion with dedicated I/O threads
+/// \file outputWriter.cpp
+#include "outputWriter.hpp"
+#include "monotonicClock.hpp"
+#include "strus/base/fileio.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+
+using namespace strus;
+
+OutputWriter::OutputWriter( int nofThreads_, std::size_t maxPendingBytes_, Checkpoint* checkpoint_)
+	:m_nofThreads(nofThreads_ > 0 ? nofThreads_ : 1),m_maxPendingBytes(maxPendingBytes_),m_checkpoint(checkpoint_)
+	,m_mutex(),m_cv_work(),m_cv_space(),m_batches(),m_pendingBytes(0),m_closed(false),m_blockedTime(0.0),m_failedFiles(),m_threads()
+{
+	try
+	{
+		for (int ti=0; ti < m_nofThreads; ++ti)
+		{
+			m_threads.push_back( new strus::thread( &OutputWriter::run, this));
+		}
+	}
+	catch (...)
+	{
+		close();
+		throw;
+	}
+}
+
+OutputWriter::~OutputWriter()
+{
+	close();
+}
+
+void OutputWriter::push( const Request& request)
+{
+	strus::unique_lock lock( m_mutex);
+	if (m_pendingBytes && m_pendingBytes + request.content.size() > m_maxPendingBytes)
+	{
+		double startTime = strus::monotonicTimeSeconds();
+		while (m_pendingBytes && m_pendingBytes + request.content.size() > m_maxPendingBytes)
+		{
+			m_cv_space.wait( lock);
+		}
+		m_blockedTime += strus::monotonicTimeSeconds() - startTime;
+	}
+	if (m_closed) throw std::runtime_error( "output writer used after close");
+	m_batches[ batchKey( request.fileCounter)].requests.push_back( request);
+	m_pendingBytes += request.content.size();
+	m_cv_work.notify_one();
+}
+
+void OutputWriter::write( int fileCounter, const std::string& filename, const std::string& content)
+{
+	push( Request( Request::Write, fileCounter, filename, content));
+}
+
+void OutputWriter::remove( int fileCounter, const std::string& filename)
+{
+	push( Request( Request::Remove, fileCounter, filename, std::string()));
+}
+
+void OutputWriter::completed( int fileCounter)
+{
+	push( Request( Request::Completed, fileCounter, std::string(), std::string()));
+}
+
+void OutputWriter::execute( const Request& request)
+{
+	int ec;
+	switch (request.type)
+	{
+		case Request::Write:
+			ec = strus::writeFile( request.filename, request.content);
+			if (ec)
+			{
+				std::cerr << "error writing file " << request.filename << ": " << std::strerror(ec) << std::endl;
+				addFailedFile( request.filename);
+			}
+			break;
+		case Request::Remove:
+			ec = strus::removeFile( request.filename, false);
+			if (ec)
+			{
+				std::cerr << "error removing file " << request.filename << ": " << std::strerror(ec) << std::endl;
+				addFailedFile( request.filename);
+			}
+			break;
+		case Request::Completed:
+			if (m_checkpoint) m_checkpoint->completed( request.fileCounter);
+			break;
+	}
+}
+
+void OutputWriter::addFailedFile( const std::string& filename)
+{
+	strus::unique_lock lock( m_mutex);
+	m_failedFiles.push_back( filename);
+}
+
+void OutputWriter::run()
+{
+	strus::unique_lock lock( m_mutex);
+	for (;;)
+	{
+		BatchMap::iterator bi = m_batches.begin(), be = m_batches.end();
+		for (; bi != be && bi->second.busy; ++bi){}
+		if (bi == be)
+		{
+			if (m_closed && m_batches.empty()) break;
+			m_cv_work.wait( lock);
+			continue;
+		}
+		//... take all requests of the first batch of the lowest directory not processed by another thread
+		std::vector<Request> requests;
+		requests.swap( bi->second.requests);
+		bi->second.busy = true;
+		lock.unlock();
+
+		std::size_t nofBytes = 0;
+		std::vector<Request>::const_iterator ri = requests.begin(), re = requests.end();
+		for (; ri != re; ++ri)
+		{
+			execute( *ri);
+			nofBytes += ri->content.size();
+		}
+		lock.lock();
+		bi->second.busy = false;
+		if (bi->second.requests.empty())
+		{
+			m_batches.erase( bi);
+		}
+		m_pendingBytes -= nofBytes;
+		m_cv_space.notify_all();
+		m_cv_work.notify_all();
+	}
+	m_cv_work.notify_all();
+}
+
+void OutputWriter::close()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_closed = true;
+		m_cv_work.notify_all();
+	}
+	std::vector<strus::thread*>::iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		(*ti)->join();
+		delete *ti;
+	}
+	m_threads.clear();
+}
+
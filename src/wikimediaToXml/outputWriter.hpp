@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Writing the output files of the conversion with dedicated I/O threads
+/// \file outputWriter.hpp
+#ifndef _STRUS_WIKIPEDIA_OUTPUT_WRITER_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_OUTPUT_WRITER_HPP_INCLUDED
+#include "checkpoint.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Stage of the conversion writing and removing the output files with dedicated I/O threads, so that the conversion threads do not block on the file system
+/// \remark Requests are collected in batches per output directory (document number / 1000) and document number modulo the number of I/O threads,
+///	so that the threads can write files of the same directory in parallel. A batch is processed by one I/O thread at a time,
+///	so the requests for the files of a document are executed in the order they were issued. The output directories are created
+///	by the caller before issuing requests for their files. The size of the contents not written yet is bounded,
+///	callers block when the limit is reached.
+class OutputWriter
+{
+public:
+	/// \brief Constructor
+	/// \param[in] nofThreads_ number of I/O threads
+	/// \param[in] maxPendingBytes_ maximum size of contents not written yet
+	/// \param[in] checkpoint_ checkpoint to notify about documents completed after their files have been written or NULL
+	OutputWriter( int nofThreads_, std::size_t maxPendingBytes_, Checkpoint* checkpoint_);
+	/// \brief Destructor, executes all requests pending
+	~OutputWriter();
+
+	/// \brief Issue writing a file
+	/// \param[in] fileCounter number of the document
+	/// \param[in] filename path of the file
+	/// \param[in] content content of the file
+	void write( int fileCounter, const std::string& filename, const std::string& content);
+	/// \brief Issue removing a file if it exists
+	/// \param[in] fileCounter number of the document
+	/// \param[in] filename path of the file
+	void remove( int fileCounter, const std::string& filename);
+	/// \brief Issue notifying the checkpoint that a document is completed, after its files issued before have been written
+	/// \param[in] fileCounter number of the document
+	void completed( int fileCounter);
+
+	/// \brief Execute all requests pending and stop the I/O threads
+	void close();
+
+	/// \brief Get the time in seconds callers were blocked because of the limit of contents not written yet
+	double blockedTime() const		{return m_blockedTime;}
+	/// \brief Get the names of the files that could not be written or removed, complete after close
+	const std::vector<std::string>& failedFiles() const	{return m_failedFiles;}
+
+private:
+	struct Request
+	{
+		enum Type {Write,Remove,Completed};
+		Type type;
+		int fileCounter;
+		std::string filename;
+		std::string content;
+
+		Request()
+			:type(Write),fileCounter(0),filename(),content(){}
+		Request( Type type_, int fileCounter_, const std::string& filename_, const std::string& content_)
+			:type(type_),fileCounter(fileCounter_),filename(filename_),content(content_){}
+		Request( const Request& o)
+			:type(o.type),fileCounter(o.fileCounter),filename(o.filename),content(o.content){}
+	};
+	struct Batch
+	{
+		std::vector<Request> requests;
+		bool busy;				//... requests of this batch are executed by an I/O thread
+
+		Batch()
+			:requests(),busy(false){}
+		Batch( const Batch& o)
+			:requests(o.requests),busy(o.busy){}
+	};
+	typedef std::map<int,Batch> BatchMap;
+
+	/// \brief Get the key of the batch of the requests of a document, ordered by output directory
+	int batchKey( int fileCounter) const	{return (fileCounter / 1000) * m_nofThreads + fileCounter % m_nofThreads;}
+	void push( const Request& request);
+	void execute( const Request& request);
+	void addFailedFile( const std::string& filename);
+	void run();
+
+private:
+	int m_nofThreads;
+	std::size_t m_maxPendingBytes;
+	Checkpoint* m_checkpoint;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cv_work;		//... signaled when requests are added or a batch is released
+	strus::condition_variable m_cv_space;		//... signaled when contents pending have been written
+	BatchMap m_batches;
+	std::size_t m_pendingBytes;
+	bool m_closed;
+	double m_blockedTime;
+	std::vector<std::string> m_failedFiles;
+	std::vector<strus::thread*> m_threads;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Scanners extracting the pages of a Wikimedia XML dump
+/// \file pageScanner.cpp
+#include "pageScanner.hpp"
+#include "textwolf/charset_utf8.hpp"
+#include <cstring>
+
+using namespace strus;
+
+bool PageFilter::match( const PageAttributes& page) const
+{
+	if (!m_namespaces.empty() && m_namespaces.find( page.ns) == m_namespaces.end())
+	{
+		return false;
+	}
+	if (!m_titlePatterns.empty())
+	{
+		std::vector<std::string>::const_iterator si = m_titlePatterns.begin(), se = m_titlePatterns.end();
+		for (; si != se && 0==std::strstr( page.title.c_str(), si->c_str()); ++si){}
+		if (si == se) return false;
+	}
+	return true;
+}
+
+static inline bool isTagSpace( unsigned char ch)
+{
+	//... space, end of line and control characters separate items in tags
+	return ch <= 32 && ch != 0;
+}
+
+static inline bool isTagNameChar( unsigned char ch)
+{
+	switch (ch)
+	{
+		case '&': case '<': case '=': case '>': case '/': case '!': case '?':
+		case '\'': case '\"': case '[': case ']':
+			return false;
+		default:
+			return ch > 32;
+	}
+}
+
+static inline const char* skipTagSpaces( const char* si, const char* se)
+{
+	while (si < se && isTagSpace( *si)) ++si;
+	return si;
+}
+
+static inline bool isTagName( const char* name, std::size_t namesize, const char* cmp, std::size_t cmpsize)
+{
+	return namesize == cmpsize && 0==std::memcmp( name, cmp, cmpsize);
+}
+
+/// \brief Decode an entity (without the leading '&') the same way as the textwolf XML scanner
+/// \return the end of the entity or NULL if the entity can not be handled
+static const char* decodeEntity( std::string& dest, const char* si, const char* se)
+{
+	if (si < se && *si == '#')
+	{
+		++si;
+		unsigned int base = 10;
+		if (si < se && *si == 'x')
+		{
+			base = 16;
+			++si;
+		}
+		unsigned int value = 0;
+		int nofDigits = 0;
+		for (; si < se && *si != ';'; ++si,++nofDigits)
+		{
+			unsigned int chval;
+			if (*si >= '0' && *si <= '9') chval = *si - '0';
+			else if (base == 16 && *si >= 'a' && *si <= 'f') chval = *si - 'a' + 10;
+			else if (base == 16 && *si >= 'A' && *si <= 'F') chval = *si - 'A' + 10;
+			else return NULL;
+			if (nofDigits == 8) return NULL;
+			value = value * base + chval;
+		}
+		if (si == se || nofDigits == 0) return NULL;
+		textwolf::charset::UTF8().print( (textwolf::UChar)value, dest);
+		return si+1;
+	}
+	else
+	{
+		const char* nameend = (const char*)std::memchr( si, ';', se - si);
+		if (!nameend || nameend - si > 4) return NULL;
+		switch (nameend - si)
+		{
+			case 2:
+				if (si[0] == 'l' && si[1] == 't') {dest.push_back( '<'); return nameend+1;}
+				if (si[0] == 'g' && si[1] == 't') {dest.push_back( '>'); return nameend+1;}
+				break;
+			case 3:
+				if (0==std::memcmp( si, "amp", 3)) {dest.push_back( '&'); return nameend+1;}
+				break;
+			case 4:
+				if (0==std::memcmp( si, "quot", 4)) {dest.push_back( '\"'); return nameend+1;}
+				if (0==std::memcmp( si, "apos", 4)) {dest.push_back( '\''); return nameend+1;}
+				if (0==std::memcmp( si, "nbsp", 4)) {dest.push_back( ' '); return nameend+1;}
+				break;
+		}
+		return NULL;
+	}
+}
+
+/// \brief Decode content or an attribute value the same way as the textwolf XML scanner
+/// \return false if the content contains anything that can not be handled
+static bool decodeContent( std::string& dest, const char* si, const char* se)
+{
+	std::size_t size = se - si;
+	if (!std::memchr( si, '&', size) && !std::memchr( si, '\r', size) && !std::memchr( si, '\0', size))
+	{
+		dest.assign( si, size);
+		return true;
+	}
+	dest.clear();
+	dest.reserve( size);
+	if (!std::memchr( si, '\r', size) && !std::memchr( si, '\0', size))
+	{
+		//... only entities to decode, copy the text between them as blocks
+		for (;;)
+		{
+			const char* amp = (const char*)std::memchr( si, '&', se - si);
+			if (!amp)
+			{
+				dest.append( si, se - si);
+				return true;
+			}
+			dest.append( si, amp - si);
+			si = decodeEntity( dest, amp+1, se);
+			if (!si) return false;
+		}
+	}
+	while (si < se)
+	{
+		switch (*si)
+		{
+			case '\0':
+				return false;
+			case '&':
+				si = decodeEntity( dest, si+1, se);
+				if (!si) return false;
+				break;
+			case '\r':
+				//... W3C end of line handling, CR LF and single CR are mapped to LF
+				dest.push_back( '\n');
+				++si;
+				if (si < se && *si == '\n') ++si;
+				break;
+			default:
+				dest.push_back( *si++);
+				break;
+		}
+	}
+	return true;
+}
+
+static const char* findPage( const char* si, const char* se)
+{
+	for (;;)
+	{
+		const char* rt = (const char*)std::memchr( si, '<', se - si);
+		if (!rt || se - rt < 6) return se;
+		if (0==std::memcmp( rt+1, "page", 4) && (rt[5] == '>' || rt[5] == '/' || isTagSpace( rt[5]))) return rt;
+		si = rt + 1;
+	}
+}
+
+static const char* findPageEnd( const char* si, const char* se)
+{
+	static const char endtag[] = "</page>";
+	enum {endtaglen = sizeof(endtag)-1};
+	for (;;)
+	{
+		const char* rt = (const char*)std::memchr( si, '<', se - si);
+		if (!rt || se - rt < endtaglen) return se;
+		if (0==std::memcmp( rt, endtag, endtaglen)) return rt + endtaglen;
+		si = rt + 1;
+	}
+}
+
+PageExtractor::Result PageExtractor::next( PageAttributes& page)
+{
+	m_pagestart = findPage( m_itr, m_end);
+	if (m_pagestart == m_end)
+	{
+		m_itr = m_end;
+		return EndOfInput;
+	}
+	page.clear();
+	if (parsePage( page))
+	{
+		m_itr = m_pageend;
+		return Page;
+	}
+	else
+	{
+		m_pageend = findPageEnd( m_pagestart, m_end);
+		m_itr = m_pageend;
+		return Anomaly;
+	}
+}
+
+bool PageExtractor::parsePage( PageAttributes& page)
+{
+	const char* si = m_pagestart;
+	const char* se = m_end;
+	int depth = 0;
+	std::string nsstr;
+	bool withNamespace = m_filter && m_filter->withNamespace();
+	bool nsKnown = false;
+	bool titleKnown = false;
+	int revisionDepth = 0;
+
+	for (;;)
+	{
+		//... si points to a '<'
+		if (si+1 >= se) return false;
+		if (si[1] == '/')
+		{
+			const char* ni = si+2;
+			while (ni < se && isTagNameChar( *ni)) ++ni;
+			if (ni == si+2) return false;
+			ni = skipTagSpaces( ni, se);
+			if (ni == se || *ni != '>') return false;
+			if (--depth == 0)
+			{
+				m_pageend = ni+1;
+				return true;
+			}
+			if (depth < revisionDepth) revisionDepth = 0;
+			si = (const char*)std::memchr( ni, '<', se - ni);
+			if (!si) return false;
+			continue;
+		}
+		const char* name = si+1;
+		const char* ni = name;
+		while (ni < se && isTagNameChar( *ni)) ++ni;
+		std::size_t namesize = ni - name;
+		if (!namesize) return false;
+		//... comments, CDATA and processing instructions are left to the generic scanner
+
+		PageTagId tagid = TagIgnored;
+		if (withNamespace && isTagName( name, namesize, "ns", 2)) tagid = TagNs;
+		else if (isTagName( name, namesize, "page", 4)) tagid = depth ? TagIgnored : TagPage;
+		else if (isTagName( name, namesize, "title", 5)) tagid = TagTitle;
+		else if (isTagName( name, namesize, "text", 4)) tagid = TagText;
+		else if (isTagName( name, namesize, "redirect", 8)) tagid = TagRedirect;
+		else if (isTagName( name, namesize, "revision", 8)) tagid = TagRevision;
+		else if (depth == 1 && isTagName( name, namesize, "id", 2)) tagid = TagPageId;
+		else if (revisionDepth && depth == revisionDepth)
+		{
+			//... only the elements directly below revision, the contributor has an id too
+			if (isTagName( name, namesize, "id", 2)) tagid = TagRevisionId;
+			else if (isTagName( name, namesize, "sha1", 4)) tagid = TagSha1;
+		}
+		if (depth && isTagName( name, namesize, "page", 4)) return false;
+		//... nested page, let the generic scanner decide
+
+		bool closed = false;
+		for (;;)
+		{
+			ni = skipTagSpaces( ni, se);
+			if (ni == se) return false;
+			if (*ni == '>')
+			{
+				++ni;
+				break;
+			}
+			if (*ni == '/')
+			{
+				++ni;
+				ni = skipTagSpaces( ni, se);
+				if (ni == se || *ni != '>') return false;
+				++ni;
+				closed = true;
+				break;
+			}
+			const char* attrname = ni;
+			while (ni < se && isTagNameChar( *ni)) ++ni;
+			std::size_t attrnamesize = ni - attrname;
+			if (!attrnamesize) return false;
+			ni = skipTagSpaces( ni, se);
+			if (ni == se || *ni != '=') return false;
+			ni = skipTagSpaces( ni+1, se);
+			if (ni == se || (*ni != '\"' && *ni != '\'')) return false;
+			const char* valstart = ni+1;
+			const char* valend = (const char*)std::memchr( valstart, *ni, se - valstart);
+			if (!valend || std::memchr( valstart, '<', valend - valstart)) return false;
+			if (tagid == TagRedirect && isTagName( attrname, attrnamesize, "title", 5))
+			{
+				if (!decodeContent( page.redirect_title, valstart, valend)) return false;
+			}
+			ni = valend+1;
+		}
+		if (closed)
+		{
+			if (tagid == TagPage)
+			{
+				m_pageend = ni;
+				return true;
+			}
+			si = (const char*)std::memchr( ni, '<', se - ni);
+			if (!si) return false;
+			continue;
+		}
+		++depth;
+		if (tagid == TagRevision) revisionDepth = depth;
+		si = (const char*)std::memchr( ni, '<', se - ni);
+		if (!si) return false;
+		if (si > ni)
+		{
+			switch (tagid)
+			{
+				case TagIgnored:
+				case TagPage:
+				case TagRevision:
+					break;
+				case TagNs:
+					if (!decodeContent( nsstr, ni, si)) return false;
+					page.ns = strus::numstring_conv::toint( nsstr, 10000);
+					nsKnown = true;
+					break;
+				case TagTitle:
+					if (!decodeContent( page.title, ni, si)) return false;
+					titleKnown = true;
+					break;
+				case TagText:
+					if (m_filter && m_filter->rejects( page, nsKnown, titleKnown)) break;
+					//... content of pages rejected is not decoded
+					if (!decodeContent( page.content, ni, si)) return false;
+					break;
+				case TagRedirect:
+					if (!decodeContent( page.redirect_title, ni, si)) return false;
+					break;
+				case TagPageId:
+					if (!decodeContent( page.page_id, ni, si)) return false;
+					break;
+				case TagRevisionId:
+					if (!decodeContent( page.revision_id, ni, si)) return false;
+					break;
+				case TagSha1:
+					if (!decodeContent( page.sha1, ni, si)) return false;
+					break;
+			}
+		}
+	}
+}
+
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Scanners extracting the pages of a Wikimedia XML dump
+/// \file pageScanner.hpp
+#ifndef _STRUS_WIKIPEDIA_PAGE_SCANNER_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_PAGE_SCANNER_HPP_INCLUDED
+#include "textwolf/xmlscanner.hpp"
+#include "textwolf/charset.hpp"
+#include "strus/base/numstring.hpp"
+#include "outputString.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Attributes of a page of a dump relevant for the conversion
+struct PageAttributes
+{
+	int ns;
+	std::string title;
+	std::string redirect_title;
+	std::string content;
+	std::string page_id;		///< id of the page in the dump
+	std::string revision_id;	///< id of the revision of the page in the dump
+	std::string sha1;		///< sha1 of the revision text as stated in the dump (base36)
+
+	PageAttributes()
+		:ns(0),title(),redirect_title(),content(),page_id(),revision_id(),sha1(){}
+	void clear()
+	{
+		ns = 0;
+		title.clear();
+		redirect_title.clear();
+		content.clear();
+		page_id.clear();
+		revision_id.clear();
+		sha1.clear();
+	}
+};
+
+/// \brief Selection of pages by namespace (option -n) and title (option -S)
+/// \remark Evaluated by the scanners as soon as namespace and title of a page are known, so that the content of rejected pages is not copied
+class PageFilter
+{
+public:
+	/// \brief Constructor
+	/// \param[in] namespaces_ set of namespaces selected or empty for all
+	/// \param[in] titlePatterns_ list of substrings of titles selected or empty for all
+	PageFilter( const std::set<int>& namespaces_, const std::vector<std::string>& titlePatterns_)
+		:m_namespaces(namespaces_),m_titlePatterns(titlePatterns_){}
+
+	/// \brief Evaluate if the namespace of a page has to be parsed
+	bool withNamespace() const
+	{
+		return !m_namespaces.empty();
+	}
+
+	/// \brief Evaluate if a page with all attributes parsed is selected
+	bool match( const PageAttributes& page) const;
+
+	/// \brief Evaluate if a page is known to be rejected with the attributes parsed so far
+	/// \param[in] page attributes of the page parsed so far
+	/// \param[in] nsKnown true if the namespace of the page has been parsed
+	/// \param[in] titleKnown true if the title of the page has been parsed
+	bool rejects( const PageAttributes& page, bool nsKnown, bool titleKnown) const
+	{
+		if (!nsKnown && !m_namespaces.empty()) return false;
+		if (!titleKnown && !m_titlePatterns.empty()) return false;
+		return !match( page);
+	}
+
+private:
+	std::set<int> m_namespaces;
+	std::vector<std::string> m_titlePatterns;
+};
+
+/// \brief Elements of a page relevant for the conversion
+enum PageTagId {TagIgnored,TagPage,TagNs,TagTitle,TagText,TagRedirect,TagPageId,TagRevision,TagRevisionId,TagSha1};
+
+/// \brief Scan the pages of a dump with the generic textwolf XML scanner
+/// \param[in] inputiterator input iterator
+/// \param[in,out] handler object with methods openPage( std::size_t position) called at the start (with the byte position of the page tag relative to the input start) and closePage( PageAttributes&) called at the end of each page (may take over the content of the page)
+/// \param[in] filter selection of pages (content of rejected pages is not copied) or NULL for all
+/// \param[in] printTokens true, if the XML elements should be printed to stdout (verbosity level 2)
+template <class InputIterator, class Handler>
+void scanPagesXml( const InputIterator& inputiterator, Handler& handler, const PageFilter* filter, bool printTokens)
+{
+	typedef textwolf::XMLScanner<InputIterator,textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlScanner;
+	bool withNamespace = filter && filter->withNamespace();
+	bool nsKnown = false;
+	bool titleKnown = false;
+	bool terminated = false;
+	XmlScanner xs( inputiterator);
+	typename XmlScanner::iterator itr=xs.begin(),end=xs.end();
+	PageAttributes docAttributes;
+	PageTagId lastTag = TagIgnored;
+	std::vector<PageTagId> tagstack;
+
+	for (; !terminated && itr!=end; ++itr)
+	{
+		if (printTokens) std::cout << "XML " << itr->name() << " " << strus::outputLineString( itr->content(), itr->content()+itr->size(), 80) << std::endl;
+		switch (itr->type())
+		{
+			case XmlScanner::None: break;
+			case XmlScanner::ErrorOccurred: throw std::runtime_error( itr->content());
+			case XmlScanner::HeaderStart:/*no break!*/
+			case XmlScanner::HeaderAttribName:/*no break!*/
+			case XmlScanner::HeaderAttribValue:/*no break!*/
+			case XmlScanner::HeaderEnd:/*no break!*/
+			case XmlScanner::DocAttribValue:/*no break!*/
+			case XmlScanner::DocAttribEnd:/*no break!*/
+				break;
+			case XmlScanner::TagAttribName:
+			{
+				if (lastTag == TagRedirect)
+				{
+					if (itr->size() == 5 && 0==std::memcmp( itr->content(), "title", itr->size()))
+					{
+						++itr;
+						if (itr->type() == XmlScanner::TagAttribValue)
+						{
+							docAttributes.redirect_title = std::string( itr->content(), itr->size());
+						}
+					}
+				}
+				break;
+			}
+			case XmlScanner::TagAttribValue:
+			{
+				break;
+			}
+			case XmlScanner::OpenTag:
+			{
+				lastTag = TagIgnored;
+				if (withNamespace && itr->size() == 2  && 0==std::memcmp( itr->content(), "ns", itr->size()))
+				{
+					lastTag = TagNs;
+				}
+				else if (itr->size() == 4 && 0==std::memcmp( itr->content(), "page", itr->size()))
+				{
+					lastTag = TagPage;
+					docAttributes.clear();
+					nsKnown = false;
+					titleKnown = false;
+					handler.openPage( xs.getTokenPosition() - 1);
+					//... the token position of a tag is the position of its name, directly after the '<' in a dump
+				}
+				else if (itr->size() == 5 && 0==std::memcmp( itr->content(), "title", itr->size()))
+				{
+					lastTag = TagTitle;
+				}
+				if (itr->size() == 4 && 0==std::memcmp( itr->content(), "text", itr->size()))
+				{
+					lastTag = TagText;
+				}
+				if (itr->size() == 8 && 0==std::memcmp( itr->content(), "redirect", itr->size()))
+				{
+					lastTag = TagRedirect;
+				}
+				else if (itr->size() == 8 && 0==std::memcmp( itr->content(), "revision", itr->size()))
+				{
+					lastTag = TagRevision;
+				}
+				else if (!tagstack.empty() && tagstack.back() == TagPage && itr->size() == 2 && 0==std::memcmp( itr->content(), "id", itr->size()))
+				{
+					lastTag = TagPageId;
+				}
+				else if (!tagstack.empty() && tagstack.back() == TagRevision)
+				{
+					//... only the elements directly below revision, the contributor has an id too
+					if (itr->size() == 2 && 0==std::memcmp( itr->content(), "id", itr->size()))
+					{
+						lastTag = TagRevisionId;
+					}
+					else if (itr->size() == 4 && 0==std::memcmp( itr->content(), "sha1", itr->size()))
+					{
+						lastTag = TagSha1;
+					}
+				}
+				tagstack.push_back( lastTag);
+				break;
+			}
+			case XmlScanner::CloseTagIm:
+			case XmlScanner::CloseTag:
+			{
+				lastTag = TagIgnored;
+				PageTagId closedTag = TagIgnored;
+				if (!tagstack.empty())
+				{
+					closedTag = tagstack.back();
+					tagstack.pop_back();
+				}
+				if (closedTag == TagPage)
+				{
+					handler.closePage( docAttributes);
+				}
+				break;
+			}
+			case XmlScanner::Content:
+				switch (lastTag)
+				{
+					case TagIgnored:
+						break;
+					case TagPage:
+						break;
+					case TagRevision:
+						break;
+					case TagNs:
+					{
+						std::string contentstr( itr->content(), itr->size());
+						docAttributes.ns = strus::numstring_conv::toint( contentstr, 10000);
+						nsKnown = true;
+						break;
+					}
+					case TagTitle:
+					{
+						docAttributes.title = std::string( itr->content(), itr->size());
+						titleKnown = true;
+						break;
+					}
+					case TagText:
+					{
+						if (filter && filter->rejects( docAttributes, nsKnown, titleKnown)) break;
+						docAttributes.content = std::string( itr->content(), itr->size());
+						break;
+					}
+					case TagRedirect:
+					{
+						docAttributes.redirect_title = std::string( itr->content(), itr->size());
+						break;
+					}
+					case TagPageId:
+					{
+						docAttributes.page_id = std::string( itr->content(), itr->size());
+						break;
+					}
+					case TagRevisionId:
+					{
+						docAttributes.revision_id = std::string( itr->content(), itr->size());
+						break;
+					}
+					case TagSha1:
+					{
+						docAttributes.sha1 = std::string( itr->content(), itr->size());
+						break;
+					}
+				}
+				break;
+			case XmlScanner::Exit:
+				terminated = true;
+				break;
+		}
+	}
+}
+
+/// \brief Fast extractor of the pages of a dump in contiguous memory
+/// \remark Jumps with memchr from tag to tag and only looks at the few elements needed (page,ns,title,redirect,text,id and id,sha1 of the revision).
+///	Content is copied as a block if it contains no entities or carriage returns, otherwise the entities present are decoded.
+///	A page containing anything the extractor can not handle with a result equal to the generic XML scanner
+///	(comments, CDATA, processing instructions, unknown entities, unquoted attributes, null characters) is
+///	reported as anomaly with its source range, that has to be processed with the generic scanner (scanPagesXml).
+class PageExtractor
+{
+public:
+	enum Result {Page, Anomaly, EndOfInput};
+
+	/// \brief Constructor
+	/// \param[in] begin_ start of the input
+	/// \param[in] end_ end of the input
+	/// \param[in] filter_ selection of pages (content of rejected pages is not copied) or NULL for all
+	PageExtractor( const char* begin_, const char* end_, const PageFilter* filter_)
+		:m_itr(begin_),m_end(end_),m_pagestart(0),m_pageend(0),m_filter(filter_){}
+
+	/// \brief Fetch the next page
+	/// \param[out] page attributes of the page extracted (only defined if Page is returned)
+	/// \return Page if a page has been extracted, Anomaly if the page between pagestart() and pageend() has to be processed with the generic scanner, EndOfInput if there are no pages left
+	Result next( PageAttributes& page);
+
+	/// \brief Start of the page fetched last
+	const char* pagestart() const		{return m_pagestart;}
+	/// \brief End of the page fetched last
+	const char* pageend() const		{return m_pageend;}
+
+private:
+	bool parsePage( PageAttributes& page);
+
+private:
+	const char* m_itr;
+	const char* m_end;
+	const char* m_pagestart;
+	const char* m_pageend;
+	const PageFilter* m_filter;
+};
+
+}//namespace
+#endif
+
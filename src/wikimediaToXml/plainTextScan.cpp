@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Scanning for the positions in Wikimedia text where a lexem other than plain text may start
+/// \file plainTextScan.cpp
+#include "plainTextScan.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace strus;
+
+//... The lexer tries the following at every position of a text, the stop mask has to cover all of them:
+//	- characters with a rule of their own: = < " & # ' [ { | ! \n } ] : / and the bytes of multibyte UTF-8 characters
+//	- timestamps, book references, hexadecimal numbers with prefix 0x: start with a digit
+//	- ISBN/ASIN references: start with "IS" or "AS"
+//	- big hexadecimal numbers without prefix: followed by at least 7 hexadecimal digits
+//	- code: 12 characters of letters, digits, '_' or multibyte characters
+//	- repeating patterns: 16 characters equal to the character 1, 2 or 3 positions ahead
+//	- bibliographic references: in a sequence of hexadecimal digits followed by one other character and a hexadecimal digit
+//... The masks below have bit i set for the byte si[i] of a window of 64 bytes, so all lookahead for the first 32 positions is inside.
+
+struct CharClassMasks
+{
+	unsigned long long stop;	//... characters with a rule of their own and digits
+	unsigned long long hex;		//... hexadecimal digits
+	unsigned long long word;	//... letters, digits, '_' and multibyte characters
+	unsigned long long isbnStart;	//... 'I' or 'A'
+	unsigned long long isbnNext;	//... 'S'
+	unsigned long long eq[3];	//... character equal to the one 1,2,3 positions ahead
+};
+
+static const unsigned long long g_highBit = 1ULL << 63;
+
+/// \brief Mask of the positions i with the bits i..i+n-1 all set, bits beyond 63 count as unset
+static unsigned long long runMask( unsigned long long mask, int n)
+{
+	unsigned long long rt = mask;
+	int len = 1;
+	for (; len * 2 <= n; len *= 2)
+	{
+		rt &= rt >> len;
+	}
+	if (len < n)
+	{
+		rt &= rt >> (n - len);
+	}
+	return rt;
+}
+
+static unsigned int stopMask( const CharClassMasks& cm)
+{
+	unsigned long long rt = cm.stop;
+	rt |= cm.isbnStart & (cm.isbnNext >> 1);
+	rt |= runMask( cm.hex, 7) >> 1;
+	rt |= runMask( cm.word, 12);
+	rt |= runMask( cm.eq[0], 16) | runMask( cm.eq[1], 16) | runMask( cm.eq[2], 16);
+
+	//... hexadecimal sequences ending with a gap of one character, the end of the window counts as such a gap
+	unsigned long long gap = (~cm.hex & (cm.hex >> 1)) | g_highBit;
+	unsigned long long bibref = cm.hex & ((gap >> 1) | g_highBit);
+	unsigned long long next = bibref | (cm.hex & (bibref >> 1));
+	while (next != bibref)
+	{
+		bibref = next;
+		next = bibref | (cm.hex & (bibref >> 1));
+	}
+	rt |= bibref;
+	return (unsigned int)(rt & 0xffffFFFFULL);
+}
+
+enum CharClass {CharStop=1, CharHex=2, CharWord=4, CharIsbnStart=8, CharIsbnNext=16};
+
+class CharClassTable
+{
+public:
+	CharClassTable()
+	{
+		for (int ci=0; ci<256; ++ci)
+		{
+			unsigned char cl = 0;
+			if (ci >= 128) cl |= CharStop | CharWord;
+			if (ci >= '0' && ci <= '9') cl |= CharStop | CharHex | CharWord;
+			if ((ci >= 'a' && ci <= 'f') || (ci >= 'A' && ci <= 'F')) cl |= CharHex;
+			if ((ci >= 'a' && ci <= 'z') || (ci >= 'A' && ci <= 'Z') || ci == '_') cl |= CharWord;
+			m_ar[ ci] = cl;
+		}
+		char const* si = "=<\"&#'[{|!\n}]:/";
+		for (; *si; ++si) m_ar[ (unsigned char)*si] |= CharStop;
+		m_ar[ (unsigned char)'I'] |= CharIsbnStart;
+		m_ar[ (unsigned char)'A'] |= CharIsbnStart;
+		m_ar[ (unsigned char)'S'] |= CharIsbnNext;
+	}
+	unsigned char operator[]( char ch) const
+	{
+		return m_ar[ (unsigned char)ch];
+	}
+
+private:
+	unsigned char m_ar[ 256];
+};
+
+static const CharClassTable g_charClassTable;
+
+unsigned int strus::plainTextStopMaskScalar( const char* si)
+{
+	CharClassMasks cm = {0,0,0,0,0,{0,0,0}};
+	//... without conditional branches, the bits are shifted in from the top
+	for (int ii=63; ii>=0; --ii)
+	{
+		unsigned char cl = g_charClassTable[ si[ ii]];
+		cm.stop = (cm.stop << 1) | (cl & CharStop);
+		cm.hex = (cm.hex << 1) | ((cl & CharHex) >> 1);
+		cm.word = (cm.word << 1) | ((cl & CharWord) >> 2);
+		cm.isbnStart = (cm.isbnStart << 1) | ((cl & CharIsbnStart) >> 3);
+		cm.isbnNext = (cm.isbnNext << 1) | ((cl & CharIsbnNext) >> 4);
+		cm.eq[0] = (cm.eq[0] << 1) | (si[ ii] == si[ ii+1]);
+		cm.eq[1] = (cm.eq[1] << 1) | (si[ ii] == si[ ii+2]);
+		cm.eq[2] = (cm.eq[2] << 1) | (si[ ii] == si[ ii+3]);
+	}
+	return stopMask( cm);
+}
+
+#if defined(__SSE2__)
+static inline unsigned long long chunkMask( __m128i vec, int chunkidx)
+{
+	return (unsigned long long)(unsigned int)_mm_movemask_epi8( vec) << (16 * chunkidx);
+}
+
+static inline __m128i inRange( __m128i vec, char lo, char hi)
+{
+	//... signed comparison, bytes >= 128 are negative and never in range
+	return _mm_and_si128( _mm_cmpgt_epi8( vec, _mm_set1_epi8( lo-1)), _mm_cmplt_epi8( vec, _mm_set1_epi8( hi+1)));
+}
+
+static inline __m128i isChar( __m128i vec, char ch)
+{
+	return _mm_cmpeq_epi8( vec, _mm_set1_epi8( ch));
+}
+
+static unsigned int stopMaskSse2( const char* si)
+{
+	CharClassMasks cm = {0,0,0,0,0,{0,0,0}};
+	for (int ci=0; ci<4; ++ci)
+	{
+		const char* chunk = si + 16 * ci;
+		__m128i vec = _mm_loadu_si128( (const __m128i*)chunk);
+		__m128i lower = _mm_or_si128( vec, _mm_set1_epi8( 0x20));
+		__m128i high = _mm_cmplt_epi8( vec, _mm_setzero_si128());
+		__m128i digit = inRange( vec, '0', '9');
+
+		__m128i stop = _mm_or_si128( high, digit);
+		stop = _mm_or_si128( stop, _mm_or_si128( isChar( vec, '='), isChar( vec, '<')));
+		stop = _mm_or_si128( stop, _mm_or_si128( isChar( vec, '"'), isChar( vec, '&')));
+		stop = _mm_or_si128( stop, _mm_or_si128( isChar( vec, '#'), isChar( vec, '\'')));
+		stop = _mm_or_si128( stop, _mm_or_si128( isChar( vec, '['), isChar( vec, '{')));
+		stop = _mm_or_si128( stop, _mm_or_si128( isChar( vec, '|'), isChar( vec, '!')));
+		stop = _mm_or_si128( stop, _mm_or_si128( isChar( vec, '\n'), isChar( vec, '}')));
+		stop = _mm_or_si128( stop, _mm_or_si128( isChar( vec, ']'), isChar( vec, ':')));
+		stop = _mm_or_si128( stop, isChar( vec, '/'));
+
+		__m128i hex = _mm_or_si128( digit, inRange( lower, 'a', 'f'));
+		__m128i word = _mm_or_si128( _mm_or_si128( digit, high), _mm_or_si128( inRange( lower, 'a', 'z'), isChar( vec, '_')));
+
+		cm.stop |= chunkMask( stop, ci);
+		cm.hex |= chunkMask( hex, ci);
+		cm.word |= chunkMask( word, ci);
+		cm.isbnStart |= chunkMask( _mm_or_si128( isChar( vec, 'I'), isChar( vec, 'A')), ci);
+		cm.isbnNext |= chunkMask( isChar( vec, 'S'), ci);
+		cm.eq[0] |= chunkMask( _mm_cmpeq_epi8( vec, _mm_loadu_si128( (const __m128i*)(chunk+1))), ci);
+		cm.eq[1] |= chunkMask( _mm_cmpeq_epi8( vec, _mm_loadu_si128( (const __m128i*)(chunk+2))), ci);
+		cm.eq[2] |= chunkMask( _mm_cmpeq_epi8( vec, _mm_loadu_si128( (const __m128i*)(chunk+3))), ci);
+	}
+	return stopMask( cm);
+}
+
+const PlainTextStopMaskFunction strus::plainTextStopMaskSse2 = &stopMaskSse2;
+const PlainTextStopMaskFunction strus::plainTextStopMaskDefault = &stopMaskSse2;
+#else
+const PlainTextStopMaskFunction strus::plainTextStopMaskSse2 = 0;
+const PlainTextStopMaskFunction strus::plainTextStopMaskDefault = &strus::plainTextStopMaskScalar;
+#endif
+
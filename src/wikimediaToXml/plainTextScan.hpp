@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Scanning for the positions in Wikimedia text where a lexem other than plain text may start
+/// \file plainTextScan.hpp
+#ifndef _STRUS_WIKIPEDIA_PLAIN_TEXT_SCAN_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_PLAIN_TEXT_SCAN_HPP_INCLUDED
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+enum {
+	PlainTextStride=32,	///< number of positions covered by one stop mask
+	PlainTextWindow=80	///< number of bytes readable from the start position required to compute a stop mask
+};
+
+/// \brief Function computing the stop mask of the positions [si,si+PlainTextStride)
+/// \param[in] si start of the positions, PlainTextWindow bytes are read from there
+/// \return mask with bit i set, if the WikimediaLexer has to look at the position si+i, unset if the position is part of a plain text for sure
+/// \remark The bits are a superset of the positions where a lexem other than text can start, the lexer decides for each of them
+typedef unsigned int (*PlainTextStopMaskFunction)( const char* si);
+
+/// \brief Portable implementation of the stop mask computation, classifying the bytes with a table
+unsigned int plainTextStopMaskScalar( const char* si);
+
+/// \brief Implementation of the stop mask computation with SSE2 instructions, classifying 16 bytes at once
+/// \note NULL if not compiled for a target supporting SSE2
+extern const PlainTextStopMaskFunction plainTextStopMaskSse2;
+
+/// \brief Best implementation of the stop mask computation available
+extern const PlainTextStopMaskFunction plainTextStopMaskDefault;
+
+}//namespace
+#endif
+
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Input stream reading ahead from another input stream in a dedicated thread
+/// \file readAheadInput.cpp
+#include "readAheadInput.hpp"
+#include "monotonicClock.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+using namespace strus;
+
+ReadAheadInput::ReadAheadInput( textwolf::IStream* source_, std::size_t bufsize_, int depth_)
+	:m_source(source_),m_buffers(),m_fillsizes(),m_depth(depth_ > 0 ? depth_ : 1)
+	,m_mutex(),m_cv_filled(),m_cv_consumed(),m_readidx(0),m_writeidx(0)
+	,m_eof(false),m_terminate(false),m_sourceError(0),m_errorcode(0)
+	,m_current(false),m_readpos(0),m_blockedTime(0.0),m_nofBlockedReads(0),m_nofBuffersRead(0),m_thread(0)
+{
+	if (bufsize_ == 0) throw std::runtime_error( "size of read ahead buffer must be positive");
+	m_buffers.resize( m_depth);
+	m_fillsizes.resize( m_depth, 0);
+	std::vector<std::string>::iterator bi = m_buffers.begin(), be = m_buffers.end();
+	for (; bi != be; ++bi) bi->resize( bufsize_);
+	m_thread = new strus::thread( &ReadAheadInput::run, this);
+}
+
+ReadAheadInput::~ReadAheadInput()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+		m_cv_consumed.notify_all();
+	}
+	m_thread->join();
+	delete m_thread;
+}
+
+void ReadAheadInput::run()
+{
+	for (;;)
+	{
+		int bufidx;
+		{
+			strus::unique_lock lock( m_mutex);
+			while (!m_terminate && m_writeidx - m_readidx >= m_depth)
+			{
+				m_cv_consumed.wait( lock);
+			}
+			if (m_terminate) return;
+			bufidx = m_writeidx % m_depth;
+		}
+		//... the buffer is not accessed by the reader until it is published by incrementing m_writeidx
+		std::string& buffer = m_buffers[ bufidx];
+		std::size_t fillsize = 0;
+		int ec = 0;
+		while (fillsize < buffer.size())
+		{
+			std::size_t nn = m_source->read( &buffer[0] + fillsize, buffer.size() - fillsize);
+			ec = m_source->errorcode();
+			fillsize += nn;
+			if (nn == 0 || ec) break;
+		}
+		{
+			strus::unique_lock lock( m_mutex);
+			m_fillsizes[ bufidx] = fillsize;
+			if (fillsize < buffer.size())
+			{
+				m_eof = true;
+				m_sourceError = ec;
+			}
+			++m_writeidx;
+			m_cv_filled.notify_all();
+			if (m_eof) return;
+		}
+	}
+}
+
+std::size_t ReadAheadInput::read( void* buf, std::size_t bufsize)
+{
+	std::size_t rt = 0;
+	while (rt < bufsize)
+	{
+		if (m_current)
+		{
+			std::size_t fillsize = m_fillsizes[ m_readidx % m_depth];
+			if (m_readpos < fillsize)
+			{
+				std::size_t nn = std::min( bufsize - rt, fillsize - m_readpos);
+				std::memcpy( (char*)buf + rt, m_buffers[ m_readidx % m_depth].c_str() + m_readpos, nn);
+				m_readpos += nn;
+				rt += nn;
+				continue;
+			}
+		}
+		strus::unique_lock lock( m_mutex);
+		if (m_current)
+		{
+			++m_readidx;
+			m_current = false;
+			m_cv_consumed.notify_all();
+		}
+		if (m_writeidx == m_readidx && !m_eof)
+		{
+			double startTime = strus::monotonicTimeSeconds();
+			while (m_writeidx == m_readidx && !m_eof)
+			{
+				m_cv_filled.wait( lock);
+			}
+			m_blockedTime += strus::monotonicTimeSeconds() - startTime;
+			++m_nofBlockedReads;
+		}
+		if (m_writeidx == m_readidx)
+		{
+			//... end of input reached, all buffers consumed
+			m_errorcode = m_sourceError;
+			break;
+		}
+		m_current = true;
+		m_readpos = 0;
+		++m_nofBuffersRead;
+	}
+	return rt;
+}
+
+int ReadAheadInput::errorcode() const
+{
+	return m_errorcode;
+}
+
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Input stream reading ahead from another input stream in a dedicated thread
+/// \file readAheadInput.hpp
+#ifndef _STRUS_WIKIPEDIA_READ_AHEAD_INPUT_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_READ_AHEAD_INPUT_HPP_INCLUDED
+#include "textwolf/istreamiterator.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Input stream reading ahead from another input stream with an I/O thread into a ring of buffers
+/// \remark The reader only waits for input if all buffers of the ring are consumed
+class ReadAheadInput
+	:public textwolf::IStream
+{
+public:
+	/// \brief Constructor
+	/// \param[in] source_ input stream to read from (not owned, used exclusively by the I/O thread)
+	/// \param[in] bufsize_ size of a buffer in bytes
+	/// \param[in] depth_ number of buffers in the ring
+	ReadAheadInput( textwolf::IStream* source_, std::size_t bufsize_, int depth_);
+	virtual ~ReadAheadInput();
+
+	virtual std::size_t read( void* buf, std::size_t bufsize);
+	virtual int errorcode() const;
+
+	/// \brief Get the time in seconds the reader was blocked waiting for input
+	double blockedTime() const			{return m_blockedTime;}
+	/// \brief Get the number of buffers the reader had to wait for
+	int nofBlockedReads() const			{return m_nofBlockedReads;}
+	/// \brief Get the number of buffers consumed
+	int nofBuffersRead() const			{return m_nofBuffersRead;}
+
+private:
+	void run();
+
+private:
+	textwolf::IStream* m_source;
+	std::vector<std::string> m_buffers;		//... ring of buffers
+	std::vector<std::size_t> m_fillsizes;		//... number of bytes filled in the buffers
+	int m_depth;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cv_filled;		//... signaled when the I/O thread filled a buffer
+	strus::condition_variable m_cv_consumed;	//... signaled when the reader consumed a buffer
+	int m_readidx;					//... number of buffers consumed by the reader
+	int m_writeidx;					//... number of buffers filled by the I/O thread
+	bool m_eof;					//... the I/O thread reached the end of the source
+	bool m_terminate;
+	int m_sourceError;				//... error of the source, reported after the data read before the error is consumed
+	int m_errorcode;
+	bool m_current;					//... the reader holds buffer m_readidx
+	std::size_t m_readpos;
+	double m_blockedTime;
+	int m_nofBlockedReads;
+	int m_nofBuffersRead;
+	strus::thread* m_thread;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Time spent and amounts processed per thread in the stages of the conversion, reported as JSON
+/// \file stageStatistics.cpp
+#include "stageStatistics.hpp"
+#include "monotonicClock.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+using namespace strus;
+
+static const char* g_stageNames[ NofConversionStages] = {"scan","lex","build","finish","toxml","report","write"};
+
+void StageCounters::clear()
+{
+	std::memset( ns, 0, sizeof(ns));
+	pages = 0;
+	documents = 0;
+	bytes = 0;
+	lexems = 0;
+	paragraphs = 0;
+	outputBytes = 0;
+}
+
+void StageCounters::add( const StageCounters& o)
+{
+	for (int si=0; si < NofConversionStages; ++si) ns[ si] += o.ns[ si];
+	pages += o.pages;
+	documents += o.documents;
+	bytes += o.bytes;
+	lexems += o.lexems;
+	paragraphs += o.paragraphs;
+	outputBytes += o.outputBytes;
+}
+
+unsigned long long StageCounters::now()
+{
+	return strus::monotonicTimeNs();
+}
+
+StageStatistics::StageStatistics( int nofScanners_, int nofWorkers_, const std::string& filename_, int interval_)
+	:m_nofScanners(nofScanners_),m_nofWorkers(nofWorkers_),m_slots(0),m_filename(filename_),m_interval(interval_)
+	,m_startTime(StageCounters::now()),m_nextReportTime(0)
+{
+	m_slots = new Slot[ m_nofScanners + m_nofWorkers];
+	m_nextReportTime = m_startTime + (unsigned long long)m_interval * 1000000000ULL;
+}
+
+StageStatistics::~StageStatistics()
+{
+	delete [] m_slots;
+}
+
+void StageStatistics::add( int threadidx, StageCounters& counters)
+{
+	Slot& slot = m_slots[ threadidx];
+	strus::unique_lock lock( slot.mutex);
+	slot.counters.add( counters);
+	counters.clear();
+}
+
+void StageStatistics::tick()
+{
+	if (!m_interval) return;
+	unsigned long long tm = StageCounters::now();
+	if (tm < m_nextReportTime) return;
+	m_nextReportTime = tm + (unsigned long long)m_interval * 1000000000ULL;
+	try
+	{
+		write();
+	}
+	catch (const std::runtime_error&)
+	{
+		//... a failing intermediate report does not stop the conversion, the final report reports the error
+	}
+}
+
+static void printCounters( std::string& out, const StageCounters& counters)
+{
+	out.append( strus::string_format( "\"pages\": %llu, \"documents\": %llu, \"bytes\": %llu, \"lexems\": %llu, \"paragraphs\": %llu, \"output_bytes\": %llu,\n\t\t\"ns\": {",
+			counters.pages, counters.documents, counters.bytes, counters.lexems, counters.paragraphs, counters.outputBytes));
+	for (int si=0; si < NofConversionStages; ++si)
+	{
+		if (si) out.append( ", ");
+		out.append( strus::string_format( "\"%s\": %llu", g_stageNames[ si], counters.ns[ si]));
+	}
+	out.append( "}");
+}
+
+std::string StageStatistics::tojson()
+{
+	std::string rt;
+	StageCounters total;
+	rt.append( strus::string_format( "{\n\"elapsed_ns\": %llu,\n\"threads\": [\n", StageCounters::now() - m_startTime));
+	for (int ti=0; ti < m_nofScanners + m_nofWorkers; ++ti)
+	{
+		StageCounters counters;
+		{
+			strus::unique_lock lock( m_slots[ ti].mutex);
+			counters = m_slots[ ti].counters;
+		}
+		total.add( counters);
+		if (ti < m_nofScanners)
+		{
+			rt.append( strus::string_format( "\t{\"thread\": \"scanner %d\", ", ti));
+		}
+		else
+		{
+			rt.append( strus::string_format( "\t{\"thread\": \"conversion %d\", ", ti - m_nofScanners + 1));
+		}
+		printCounters( rt, counters);
+		rt.append( ti + 1 < m_nofScanners + m_nofWorkers ? "},\n" : "}\n");
+	}
+	rt.append( "],\n\"total\": {");
+	printCounters( rt, total);
+	rt.append( "}\n}\n");
+	return rt;
+}
+
+void StageStatistics::write()
+{
+	//... written to a temporary file renamed, so that a reader never sees a partial report
+	std::string tmpfilename = m_filename + ".tmp";
+	int ec = strus::writeFile( tmpfilename, tojson());
+	if (ec) throw std::runtime_error( strus::string_format( "failed to write statistics file '%s': %s", tmpfilename.c_str(), ::strerror(ec)));
+	if (0 != std::rename( tmpfilename.c_str(), m_filename.c_str()))
+	{
+		ec = errno;
+		throw std::runtime_error( strus::string_format( "failed to rename statistics file '%s': %s", tmpfilename.c_str(), ::strerror(ec)));
+	}
+}
+
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Time spent and amounts processed per thread in the stages of the conversion, reported as JSON
+/// \file stageStatistics.hpp
+#ifndef _STRUS_WIKIPEDIA_STAGE_STATISTICS_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_STAGE_STATISTICS_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <string>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Stages of the conversion measured
+enum ConversionStage
+{
+	StageScan,		///< scanning the input for pages (XML scanner or fast page extractor)
+	StageLex,		///< lexing the content, the time spent in WikimediaLexer::parse (or WikimediaLexer::next with -VV) between the lexems passed to the handler
+	StageBuild,		///< building the document structure from the lexems
+	StageFinish,		///< DocumentStructure::finish
+	StageToXml,		///< DocumentStructure::toxml
+	StageReport,		///< building the reports of strange features, errors and unresolved links
+	StageWrite		///< writing the output files
+};
+enum {NofConversionStages=7};
+
+/// \brief Counters of a thread, collected without synchronization and added to the statistics of the thread from time to time
+struct StageCounters
+{
+	unsigned long long ns[ NofConversionStages];	///< nanoseconds spent per stage
+	unsigned long long pages;			///< number of pages scanned
+	unsigned long long documents;			///< number of documents converted
+	unsigned long long bytes;			///< number of bytes of the contents of the documents converted
+	unsigned long long lexems;			///< number of lexems processed
+	unsigned long long paragraphs;			///< number of paragraphs of the documents built
+	unsigned long long outputBytes;			///< number of bytes of the XML output
+
+	StageCounters()
+	{
+		clear();
+	}
+	void clear();
+	void add( const StageCounters& o);
+
+	/// \brief Current time of a monotonic clock in nanoseconds
+	static unsigned long long now();
+};
+
+/// \brief Clock adding the time spent to the counters of a stage, does nothing if the counters are NULL (statistics disabled)
+class StageClock
+{
+public:
+	explicit StageClock( StageCounters* counters_)
+		:m_counters(counters_),m_start(counters_ ? StageCounters::now() : 0){}
+
+	/// \brief Add the time since the last call or the construction to the counters of a stage
+	void stop( ConversionStage stage)
+	{
+		if (m_counters)
+		{
+			unsigned long long tm = StageCounters::now();
+			m_counters->ns[ stage] += tm - m_start;
+			m_start = tm;
+		}
+	}
+
+private:
+	StageCounters* m_counters;
+	unsigned long long m_start;
+};
+
+/// \brief Statistics of the conversion per thread, written as JSON report
+/// \remark The threads are identified by an index, the scanner threads first, then the conversion threads.
+///	Threads collect their counters locally and add them per document, so a lock is only taken once per document.
+class StageStatistics
+{
+public:
+	/// \brief Constructor
+	/// \param[in] nofScanners_ number of scanner threads
+	/// \param[in] nofWorkers_ number of conversion threads
+	/// \param[in] filename_ name of the file the report is written to
+	/// \param[in] interval_ seconds between reports written while the conversion is running or 0 for a report at the end only
+	StageStatistics( int nofScanners_, int nofWorkers_, const std::string& filename_, int interval_);
+	~StageStatistics();
+
+	/// \brief Add the counters of a thread and clear them (thread safe)
+	/// \param[in] threadidx index of the thread
+	/// \param[in,out] counters counters to add
+	void add( int threadidx, StageCounters& counters);
+
+	/// \brief Write a report if the interval since the last report has elapsed (option --statsinterval), only called by one scanner thread
+	void tick();
+	/// \brief Write a report with the current state, throws on error
+	void write();
+
+	/// \brief Get the report as JSON
+	std::string tojson();
+
+private:
+	StageStatistics( const StageStatistics&);	//... non copyable
+	void operator=( const StageStatistics&);	//... non copyable
+
+	struct Slot
+	{
+		strus::mutex mutex;
+		StageCounters counters;
+	};
+
+private:
+	int m_nofScanners;
+	int m_nofWorkers;
+	Slot* m_slots;
+	std::string m_filename;
+	int m_interval;
+	unsigned long long m_startTime;
+	unsigned long long m_nextReportTime;
+};
+
+}//namespace
+#endif
+
@@ -24,6 +24,19 @@
 #include "documentStructure.hpp"
 #include "outputString.hpp"
 #include "wikimediaLexer.hpp"
+#include "mappedFile.hpp"
+#include "bzip2Input.hpp"
+#include "pageScanner.hpp"
+#include "readAheadInput.hpp"
+#include "checkpoint.hpp"
+#include "manifest.hpp"
+#include "tarArchive.hpp"
+#include "outputWriter.hpp"
+#include "cpuAffinity.hpp"
+#include "testOutput.hpp"
+#include "stageStatistics.hpp"
+#include "cpuDeadline.hpp"
+#include "monotonicClock.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -34,8 +47,12 @@
 #include <memory>
 #include <vector>
 #include <set>
-#include <queue>
 #include <limits>
+#include <algorithm>
+#include <sched.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 static int g_verbosity = 0;
 static bool g_beautified = false;
@@ -44,12 +61,124 @@ static bool g_singleIdAttribute = true;
 static bool g_dumpStdout = false;
 static bool g_doTest = false;
 static std::string g_testExpectedFilename;
-static std::string g_testOutput;
+static strus::TestOutput* g_testOutput = NULL;
 static std::string g_outputdir;
+static strus::OutputArchives* g_outputArchives = NULL;
+static strus::OutputWriter* g_outputWriter = NULL;
+static int g_nofIoThreads = 0;
+enum {MaxPendingOutputMB=64};
+static int g_archiveSize = 0;
 static const strus::LinkMap* g_linkmap = NULL;
 static strus::ErrorBufferInterface* g_errorhnd = NULL;
+static bool g_useMemoryMap = false;
+static int g_bzip2Threads = 0;
+static int g_bzip2SegmentKB = 0;
+static int g_nofShards = 0;
+static int g_scheduleWindow = 0;
+static int g_maxQueuedDocs = -1;
+static int g_maxQueuedMB = -1;		//... no limit by default, the documents queued are bounded by the queue size only
+enum {DefaultBatchDocs=1,DefaultBatchKB=64};
+//... no batching by default, a gain of batching has not been measured yet
+static int g_batchDocs = 0;
+static int g_batchKB = 0;
+enum DocNumbering {NumberByOrder,NumberByPageId,NumberByTitleHash};
+static DocNumbering g_docNumbering = NumberByOrder;
+static bool g_fastScan = false;
+static int g_readAheadDepth = 0;
+static int g_readAheadSize = 0;
+static std::string g_bzip2IndexFile;
+static bool g_collectRedirects = false;
+static int g_counterMod = 0;
+static std::set<int> g_namespacemap;
+static std::vector<std::string> g_selectDocumentPattern;
+static std::string g_dumpfilename;
+static const strus::PageFilter* g_pageFilter = NULL;
+static strus::Checkpoint* g_checkpoint = NULL;
+static strus::Manifest* g_manifest = NULL;
+static std::string g_manifestFile;
+static std::string g_previousManifestFile;
+static std::string g_checkpointFile;
+static int g_checkpointInterval = 0;
+static bool g_resume = false;
+static std::vector<int> g_cpuAffinity;
+static int g_docCpuLimitMs = 0;
+static strus::mutex g_timedOutDocumentsMutex;
+static std::vector<std::string> g_timedOutDocuments;
+static strus::mutex g_skippedDocumentsMutex;
+static std::vector<std::string> g_skippedDocuments;
+static strus::mutex g_failedOutputFilesMutex;
+static std::vector<std::string> g_failedOutputFiles;
+static strus::StageStatistics* g_statistics = NULL;
+static std::string g_statisticsFile;
+static int g_statisticsInterval = 0;
 
-typedef textwolf::XMLScanner<textwolf::IStreamIterator,textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlScanner;
+
+/// \brief Remember a document aborted because of the CPU time limit for the summary at the end (option --cpulimit)
+static void addTimedOutDocument( const std::string& title, const std::string& docid)
+{
+	strus::unique_lock lock( g_timedOutDocumentsMutex);
+	g_timedOutDocuments.push_back( title + " (" + docid + ")");
+}
+
+/// \brief Remember a document skipped because of a missing or invalid page id for the summary at the end (option --numbering pageid)
+static void addSkippedDocument( const std::string& title)
+{
+	strus::unique_lock lock( g_skippedDocumentsMutex);
+	g_skippedDocuments.push_back( title);
+}
+
+/// \brief Remember an output file that could not be written or removed for the summary at the end
+static void addFailedOutputFile( const std::string& filename)
+{
+	strus::unique_lock lock( g_failedOutputFilesMutex);
+	g_failedOutputFiles.push_back( filename);
+}
+
+/// \brief Number of threads scanning the input, placed before the conversion threads on the CPUs of option --affinity
+static int nofScannerThreads()
+{
+	return g_nofShards ? g_nofShards : 1;
+}
+
+/// \brief Get the CPU a thread is bound to (option --affinity)
+/// \param[in] placementIndex index of the thread, the scanner threads first, then the conversion threads
+/// \return the CPU or -1 if the thread is not bound
+static int getThreadCpu( int placementIndex)
+{
+	if (g_cpuAffinity.empty()) return -1;
+	return g_cpuAffinity[ placementIndex % g_cpuAffinity.size()];
+}
+
+/// \brief Bind the calling thread to its CPU if specified (option --affinity)
+/// \remark Only the thread is bound, the documents passed to a conversion thread are allocated by the scanner and not placed on the NUMA node of its CPU
+static void bindThread( int placementIndex)
+{
+	int cpu = getThreadCpu( placementIndex);
+	if (cpu < 0) return;
+	int ec = strus::bindThreadToCpu( cpu);
+	if (ec) std::cerr << strus::string_format( "failed to bind thread to CPU %d: %s", cpu, ::strerror(ec)) << std::endl;
+}
+
+/// \brief Print the CPUs and NUMA nodes the threads are bound to (option --affinity)
+static void printThreadPlacement( int nofThreads)
+{
+	int nofScanners = nofScannerThreads();
+	for (int ti=0; ti < nofScanners + nofThreads; ++ti)
+	{
+		int cpu = getThreadCpu( ti);
+		int node = strus::getCpuNumaNode( cpu);
+		std::string nodestr = node < 0 ? std::string("unknown") : strus::string_format( "%d", node);
+		if (ti < nofScanners)
+		{
+			std::cerr << strus::string_format( "scanner %d on CPU %d (NUMA node %s)\n", ti, cpu, nodestr.c_str());
+		}
+		else
+		{
+			std::cerr << strus::string_format( "thread %d on CPU %d (NUMA node %s)\n", ti - nofScanners + 1, cpu, nodestr.c_str());
+		}
+	}
+	std::cerr << std::flush;
+}
 
 static std::string attributesToString( const strus::WikimediaLexem::AttributeMap& attributes)
 {
@@ -77,142 +206,147 @@ static std::string getLinkDomainPrefix( const std::string& lnk)
 	}
 }
 
-static void parseDocumentText( strus::DocumentStructure& doc, const char* src, std::size_t size)
+/// \brief Handler building the document structure from the lexems of a document (see WikimediaLexer::parse)
+class DocumentTextHandler
 {
-	strus::WikimediaLexer lexer(src,size);
-	int lexemidx = 0;
-	int lastHeading = 1;
-	bool verboseOutput = (g_verbosity >= 2);
+public:
+	/// \param[in,out] counters_ counters of the stages of the conversion (option --stats) or NULL
+	/// \param[in,out] deadline_ CPU time limit of the conversion of the document (option --cpulimit) or NULL
+	DocumentTextHandler( strus::DocumentStructure& doc_, const strus::WikimediaLexer& lexer_, strus::StageCounters* counters_, strus::CpuDeadline* deadline_)
+		:m_doc(doc_),m_lexer(lexer_),m_counters(counters_),m_clock(counters_),m_lexemidx(0),m_deadline(deadline_){}
 
-	for (strus::WikimediaLexem lexem = lexer.next(); lexem.id != strus::WikimediaLexem::EoF; lexem = lexer.next(),++lexemidx)
+	void lexem( strus::WikimediaLexem::Id id, int idx, const char* value, std::size_t valuesize, const strus::WikimediaLexem::AttributeMap& attributes)
 	{
-		if (verboseOutput)
+		m_clock.stop( strus::StageLex);
+		if (m_counters) ++m_counters->lexems;
+		if (m_deadline) m_deadline->poll();
+		if (g_verbosity >= 2)
 		{
-			std::cout << "STATE " << doc.statestring() << std::endl;
-			std::cout << lexemidx << " LEXEM " << strus::WikimediaLexem::idName( lexem.id) << " " << strus::outputLineString( lexem.value.c_str(), lexem.value.c_str() + lexem.value.size());
-			if (!lexem.attributes.empty()) std::cout << " -- " << attributesToString( lexem.attributes);
+			std::cout << "STATE " << m_doc.statestring() << std::endl;
+			std::cout << m_lexemidx << " LEXEM " << strus::WikimediaLexem::idName( id) << " " << strus::outputLineString( value, value + valuesize);
+			if (!attributes.empty()) std::cout << " -- " << attributesToString( attributes);
 			std::cout << std::endl;
 		}
-		switch (lexem.id)
+		switch (id)
 		{			
 			case strus::WikimediaLexem::EoF:
 				break;
 			case strus::WikimediaLexem::Error:
-				doc.addError( std::string("syntax error in document: ") + strus::outputLineString( lexem.value.c_str()));
+				m_doc.addError( std::string("syntax error in document: ") + strus::outputLineString( value, value + valuesize));
 				break;
 			case strus::WikimediaLexem::Text:
-				doc.addText( lexem.value);
+				m_doc.addText( value, valuesize);
 				break;
 			case strus::WikimediaLexem::String:
-				doc.closeOpenQuoteItems();
-				doc.addQuotationMarker();
-				doc.addText( lexem.value);
-				doc.addQuotationMarker();
+				m_doc.closeOpenQuoteItems();
+				m_doc.addQuotationMarker();
+				m_doc.addText( value, valuesize);
+				m_doc.addQuotationMarker();
 				break;
 			case strus::WikimediaLexem::Char:
-				doc.addChar( lexem.value);
+				m_doc.addChar( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::Math:
-				doc.addMath( lexem.value);
+				m_doc.addMath( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::BibRef:
-				doc.addBibRef( lexem.value);
+				m_doc.addBibRef( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::NoWiki:
-				doc.addNoWiki( lexem.value);
+				m_doc.addNoWiki( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::NoData:
-				doc.addError( std::string("lexem can not be treated as data: ") + strus::outputLineString( lexem.value.c_str()));
+				m_doc.addError( std::string("lexem can not be treated as data: ") + strus::outputLineString( value, value + valuesize));
 				break;
 			case strus::WikimediaLexem::Code:
-				doc.addCode( lexem.value);
+				m_doc.addCode( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::Timestamp:
-				doc.addTimestamp( lexem.value);
+				m_doc.addTimestamp( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::Url:
-				doc.openWebLink( lexem.value);
-				doc.closeWebLink();
+				m_doc.openWebLink( std::string( value, valuesize));
+				m_doc.closeWebLink();
 				break;
 			case strus::WikimediaLexem::Redirect:
-				doc.addError( "unexpected redirect in document");
+				m_doc.addError( "unexpected redirect in document");
 				break;
 			case strus::WikimediaLexem::Markup:
-				doc.addMarkup( lexem.value);
+				m_doc.addMarkup( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::OpenHeading:
-				doc.openHeading( lastHeading = (int)lexem.idx);
+				m_doc.openHeading( idx);
 				break;
 			case strus::WikimediaLexem::CloseHeading:
-				doc.closeHeading();
+				m_doc.closeHeading();
 				break;
 			case strus::WikimediaLexem::OpenRef:
-				doc.openRef();
+				m_doc.openRef();
 				break;
 			case strus::WikimediaLexem::CloseRef:
-				doc.closeRef();
+				m_doc.closeRef();
 				break;
 			case strus::WikimediaLexem::HeadingItem:
-				doc.addHeadingItem();
+				m_doc.addHeadingItem();
 				break;
 			case strus::WikimediaLexem::ListItem:
-				doc.openListItem( (int)lexem.idx);
+				m_doc.openListItem( idx);
 				break;
 			case strus::WikimediaLexem::EndOfLine:
-				doc.closeOpenEolnItem();
-				doc.addText( "\n");
+				m_doc.closeOpenEolnItem();
+				m_doc.addText( "\n");
 				break;
 			case strus::WikimediaLexem::QuotationMarker:
-				doc.addQuotationMarker();
+				m_doc.addQuotationMarker();
 				break;
 			case strus::WikimediaLexem::MultiQuoteMarker:
-				doc.addMultiQuoteMarker( (int)lexem.idx);
+				m_doc.addMultiQuoteMarker( idx);
 				break;
 			case strus::WikimediaLexem::OpenSpan:
-				doc.openSpan();
+				m_doc.openSpan();
 				break;
 			case strus::WikimediaLexem::CloseSpan:
-				doc.closeSpan();
+				m_doc.closeSpan();
 				break;
 			case strus::WikimediaLexem::OpenFormat:
-				doc.openFormat();
+				m_doc.openFormat();
 				break;
 			case strus::WikimediaLexem::CloseFormat:
-				doc.closeFormat();
+				m_doc.closeFormat();
 				break;
 			case strus::WikimediaLexem::OpenBlockQuote:
-				doc.openBlockQuote();
+				m_doc.openBlockQuote();
 				break;
 			case strus::WikimediaLexem::CloseBlockQuote:
-				doc.closeBlockQuote();
+				m_doc.closeBlockQuote();
 				break;
 			case strus::WikimediaLexem::OpenDiv:
-				doc.openDiv();
+				m_doc.openDiv();
 				break;
 			case strus::WikimediaLexem::CloseDiv:
-				doc.closeDiv();
+				m_doc.closeDiv();
 				break;
 			case strus::WikimediaLexem::OpenPoem:
-				doc.openPoem();
+				m_doc.openPoem();
 				break;
 			case strus::WikimediaLexem::ClosePoem:
-				doc.closePoem();
+				m_doc.closePoem();
 				break;
 			case strus::WikimediaLexem::OpenCitation:
-				doc.openCitation( lexem.value);
+				m_doc.openCitation( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::CloseCitation:
-				doc.closeCitation();
+				m_doc.closeCitation();
 				break;
 			case strus::WikimediaLexem::OpenWWWLink:
-				doc.openWebLink( lexem.value);
+				m_doc.openWebLink( std::string( value, valuesize));
 				break;
 			case strus::WikimediaLexem::CloseWWWLink:
-				doc.closeWebLink();
+				m_doc.closeWebLink();
 				break;
 			case strus::WikimediaLexem::OpenPageLink:
 			{
-				std::pair<std::string,std::string> lnk = strus::LinkMap::getLinkParts( lexem.value);
+				std::pair<std::string,std::string> lnk = strus::LinkMap::getLinkParts( std::string( value, valuesize));
 				if (g_linkmap)
 				{
 					std::string prefix = getLinkDomainPrefix( lnk.first);
@@ -222,75 +356,75 @@ static void parseDocumentText( strus::DocumentStructure& doc, const char* src, s
 					}
 					if (prefix == "file" || prefix == "image")
 					{
-						doc.openPageLink( lnk.first, lnk.second);
+						m_doc.openPageLink( lnk.first, lnk.second);
 					}
 					else
 					{
 						const char* val = g_linkmap->get( lnk.first);
 						if (val)
 						{
-							doc.openPageLink( val, lnk.second);
+							m_doc.openPageLink( val, lnk.second);
 						}
 						else
 						{
-							doc.addUnresolved( lexem.value);
-							doc.openPageLink( lnk.first, lnk.second);
+							m_doc.addUnresolved( std::string( value, valuesize));
+							m_doc.openPageLink( lnk.first, lnk.second);
 						}
 					}
 				}
 				else
 				{
-					doc.openPageLink( lnk.first, lnk.second);
+					m_doc.openPageLink( lnk.first, lnk.second);
 				}
 				break;
 			}
 			case strus::WikimediaLexem::ClosePageLink:
-				doc.closePageLink();
+				m_doc.closePageLink();
 				break;
 			case strus::WikimediaLexem::OpenTable:
-				doc.openTable();
+				m_doc.openTable();
 				break;
 			case strus::WikimediaLexem::CloseTable:
-				doc.closeOpenEolnItem();
-				doc.closeTable();
+				m_doc.closeOpenEolnItem();
+				m_doc.closeTable();
 				break;
 			case strus::WikimediaLexem::TableTitle:
-				doc.closeOpenEolnItem();
-				doc.implicitOpenTableIfUndefined();
-				doc.addTableTitle();
+				m_doc.closeOpenEolnItem();
+				m_doc.implicitOpenTableIfUndefined();
+				m_doc.addTableTitle();
 				break;
 			case strus::WikimediaLexem::TableHeadDelim:
 			{
-				doc.closeOpenEolnItem();
-				doc.implicitOpenTableIfUndefined();
-				int colspan = lexem.colspan();
+				m_doc.closeOpenEolnItem();
+				m_doc.implicitOpenTableIfUndefined();
+				int colspan = strus::WikimediaLexem::colspan( attributes);
 				if (colspan <= 0)
 				{
-					doc.addError( "invalid colspan attribute value");
+					m_doc.addError( "invalid colspan attribute value");
 					colspan = 0;
 				}
-				int rowspan = lexem.rowspan();
+				int rowspan = strus::WikimediaLexem::rowspan( attributes);
 				if (rowspan <= 0)
 				{
-					doc.addError( "invalid colspan attribute value");
+					m_doc.addError( "invalid colspan attribute value");
 					rowspan = 0;
 				}
-				doc.addTableHead( rowspan, colspan);
+				m_doc.addTableHead( rowspan, colspan);
 				break;
 			}
 			case strus::WikimediaLexem::TableRowDelim:
-				doc.closeOpenEolnItem();
-				doc.implicitOpenTableIfUndefined();
-				doc.addTableRow();
+				m_doc.closeOpenEolnItem();
+				m_doc.implicitOpenTableIfUndefined();
+				m_doc.addTableRow();
 				break;
 			case strus::WikimediaLexem::TableColDelim:
 			{
-				doc.closeOpenEolnItem();
-				strus::Paragraph::StructType tp = doc.currentStructType();
+				m_doc.closeOpenEolnItem();
+				strus::Paragraph::StructType tp = m_doc.currentStructType();
 				if (tp == strus::Paragraph::StructPageLink
 				||  tp == strus::Paragraph::StructWebLink)
 				{
-					doc.clearOpenText();
+					m_doc.clearOpenText();
 					//... ignore last text and restart structure
 				}
 				else
@@ -298,135 +432,189 @@ static void parseDocumentText( strus::DocumentStructure& doc, const char* src, s
 				||  tp == strus::Paragraph::StructRef
 				||  tp == strus::Paragraph::StructAttribute)
 				{
-					doc.addAttribute( lexem.value);
+					m_doc.addAttribute( std::string( value, valuesize));
 				}
 				else if (tp == strus::Paragraph::StructNone)
 				{
-					doc.openListItem( 1);
+					m_doc.openListItem( 1);
 				}
 				else
 				{
-					int colspan = lexem.colspan();
+					int colspan = strus::WikimediaLexem::colspan( attributes);
 					if (colspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						colspan = 0;
 					}
-					int rowspan = lexem.rowspan();
+					int rowspan = strus::WikimediaLexem::rowspan( attributes);
 					if (rowspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						rowspan = 0;
 					}
-					doc.addTableCell( rowspan, colspan);
+					m_doc.addTableCell( rowspan, colspan);
 				}
 				break;
 			}
 			case strus::WikimediaLexem::ColDelim:
 			{
-				doc.closeOpenQuoteItems();
-				strus::Paragraph::StructType tp = doc.currentStructType();
+				m_doc.closeOpenQuoteItems();
+				strus::Paragraph::StructType tp = m_doc.currentStructType();
 				if (tp == strus::Paragraph::StructPageLink
 				||  tp == strus::Paragraph::StructWebLink)
 				{
-					doc.clearOpenText();
+					m_doc.clearOpenText();
 					//... ignore last text and restart structure
 				}
 				else if (tp == strus::Paragraph::StructList)
 				{
-					doc.addText( " |");
+					m_doc.addText( " |");
 					//... ignore
 				}
 				else if (tp == strus::Paragraph::StructTableTitle)
 				{
-					doc.addTableTitle();
+					m_doc.addTableTitle();
 				}
 				else if (tp == strus::Paragraph::StructTableHead
 					|| tp == strus::Paragraph::StructTableCell)
 				{
-					int colspan = lexem.colspan();
+					int colspan = strus::WikimediaLexem::colspan( attributes);
 					if (colspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						colspan = 0;
 					}
-					int rowspan = lexem.rowspan();
+					int rowspan = strus::WikimediaLexem::rowspan( attributes);
 					if (rowspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						rowspan = 0;
 					}
-					doc.repeatTableCell( rowspan, colspan);
+					m_doc.repeatTableCell( rowspan, colspan);
 				}
 				else
 				{
-					doc.addAttribute( lexem.value);
+					m_doc.addAttribute( std::string( value, valuesize));
 				}
 				break;
 			}
 			case strus::WikimediaLexem::DoubleColDelim:
 			{
-				doc.closeOpenQuoteItems();
-				strus::Paragraph::StructType tp = doc.currentStructType();
+				m_doc.closeOpenQuoteItems();
+				strus::Paragraph::StructType tp = m_doc.currentStructType();
 				if (tp == strus::Paragraph::StructPageLink
 				||  tp == strus::Paragraph::StructWebLink)
 				{
-					doc.clearOpenText();
+					m_doc.clearOpenText();
 					//... ignore last text and restart structure
 				}
 				else if (tp == strus::Paragraph::StructTableTitle)
 				{
-					doc.addTableTitle();
+					m_doc.addTableTitle();
 				}
 				else if (tp == strus::Paragraph::StructTableHead
 					|| tp == strus::Paragraph::StructTableCell)
 				{
-					int colspan = lexem.colspan();
+					int colspan = strus::WikimediaLexem::colspan( attributes);
 					if (colspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						colspan = 0;
 					}
-					int rowspan = lexem.rowspan();
+					int rowspan = strus::WikimediaLexem::rowspan( attributes);
 					if (rowspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						rowspan = 0;
 					}
-					doc.repeatTableCell( rowspan, colspan);
+					m_doc.repeatTableCell( rowspan, colspan);
 				}
 				else if (tp == strus::Paragraph::StructCitation || tp == strus::Paragraph::StructAttribute)
 				{
-					doc.addAttribute( lexem.value);
+					m_doc.addAttribute( std::string( value, valuesize));
 				}
 				else if (tp == strus::Paragraph::StructTable)
 				{
-					int colspan = lexem.colspan();
+					int colspan = strus::WikimediaLexem::colspan( attributes);
 					if (colspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						colspan = 0;
 					}
-					int rowspan = lexem.rowspan();
+					int rowspan = strus::WikimediaLexem::rowspan( attributes);
 					if (rowspan <= 0)
 					{
-						doc.addError( "invalid colspan attribute value");
+						m_doc.addError( "invalid colspan attribute value");
 						rowspan = 0;
 					}
-					doc.addTableCell( rowspan, colspan);
+					m_doc.addTableCell( rowspan, colspan);
 				}
 				else
 				{
-					doc.addError( "unexpected token '||'");
+					m_doc.addError( "unexpected token '||'");
 				}
 			}
 		}
-		if (doc.hasNewErrors())
+		if (m_doc.hasNewErrors())
+		{
+			m_doc.setErrorsSourceInfo( m_lexer.currentSourceExtract( 60));
+		}
+		++m_lexemidx;
+		m_clock.stop( strus::StageBuild);
+	}
+
+private:
+	strus::DocumentStructure& m_doc;
+	const strus::WikimediaLexer& m_lexer;
+	strus::StageCounters* m_counters;
+	strus::StageClock m_clock;
+	int m_lexemidx;
+	strus::CpuDeadline* m_deadline;
+};
+
+/// \param[in,out] counters counters of the stages of the conversion (option --stats) or NULL
+/// \param[in,out] deadline CPU time limit of the conversion of the document (option --cpulimit) or NULL
+static void parseDocumentText( strus::DocumentStructure& doc, const char* src, std::size_t size, strus::StageCounters* counters, strus::CpuDeadline* deadline)
+{
+	strus::WikimediaLexer lexer(src,size);
+	lexer.setDeadline( deadline);
+	DocumentTextHandler handler( doc, lexer, counters, deadline);
+	if (g_verbosity >= 2)
+	{
+		//... debug output with the lexem objects of the pull interface
+		for (strus::WikimediaLexem lexem = lexer.next(); lexem.id != strus::WikimediaLexem::EoF; lexem = lexer.next())
 		{
-			doc.setErrorsSourceInfo( lexer.currentSourceExtract( 60));
+			handler.lexem( lexem.id, lexem.idx, lexem.value.data(), lexem.value.size(), lexem.attributes);
 		}
-		
 	}
+	else
+	{
+		lexer.parse( handler);
+	}
+}
+
+enum {TitleHashRange=10000000};
+//... range of document numbers derived from a title hash, giving 10000 output directories
+
+/// \brief Get the hash of a title or a document id, FNV-1a, stable across platforms and runs
+static unsigned int getTitleHash( const std::string& title)
+{
+	unsigned int rt = 2166136261U;
+	std::string::const_iterator ti = title.begin(), te = title.end();
+	for (; ti != te; ++ti)
+	{
+		rt ^= (unsigned char)*ti;
+		rt *= 16777619U;
+	}
+	return rt;
+}
+
+/// \brief Get the document number of a title (option --numbering titlehash)
+/// \remark The number depends only on the title, titles with colliding hashes get the same number.
+///	It is not used as suffix of file names of long titles, see getFilenameFromDocid.
+static int getTitleHashDocIndex( const std::string& title)
+{
+	return getTitleHash( title) % TitleHashRange;
 }
 
 static void createOutputDir( int fileCounter)
@@ -446,10 +634,20 @@ static std::string getFilenameFromDocid( int fileCounter, const std::string& doc
 	}
 	else
 	{
-		return std::string( docid.c_str(), 110) + "__" + strus::string_format( "%d", fileCounter);
+		//... the document number is not unique if numbered by title hash, the full hash of the document id is used there instead
+		return std::string( docid.c_str(), 110) + "__" + (g_docNumbering == NumberByTitleHash
+				? strus::string_format( "%08x", getTitleHash( docid))
+				: strus::string_format( "%d", fileCounter));
 	}
 }
 
+static std::string getWorkFileName( int fileCounter, const std::string& docid, const std::string& extension)
+{
+	char dirnam[ 16];
+	std::snprintf( dirnam, sizeof(dirnam), "%04u", fileCounter / 1000);
+	return strus::joinFilePath( dirnam, getFilenameFromDocid( fileCounter, docid) + extension);
+}
+
 static void writeWorkFile( int fileCounter, const std::string& docid, const std::string& extension, const std::string& content)
 {
 	char dirnam[ 16];
@@ -458,7 +656,7 @@ static void writeWorkFile( int fileCounter, const std::string& docid, const std:
 
 	if (g_dumpStdout || g_doTest)
 	{
-		std::string filename( strus::joinFilePath( dirnam, getFilenameFromDocid( fileCounter, docid) + extension));
+		std::string filename( getWorkFileName( fileCounter, docid, extension));
 		if (g_dumpStdout)
 		{
 			std::cout << "## " << filename << std::endl;
@@ -469,28 +667,91 @@ static void writeWorkFile( int fileCounter, const std::string& docid, const std:
 			std::ostringstream out;
 			out << "## " << filename << std::endl;
 			out << content << std::endl << std::endl;
-			g_testOutput.append( out.str());
+			g_testOutput->write( fileCounter, out.str());
+		}
+	}
+	else if (g_outputArchives)
+	{
+		std::string filename( getWorkFileName( fileCounter, docid, extension));
+		try
+		{
+			g_outputArchives->write( fileCounter, filename, content);
+		}
+		catch (const std::runtime_error& err)
+		{
+			std::cerr << "error writing file " << filename << " to archive: " << err.what() << std::endl;
+			addFailedOutputFile( filename);
 		}
 	}
 	else
 	{
 		std::string filename( strus::joinFilePath( strus::joinFilePath( g_outputdir, dirnam), getFilenameFromDocid( fileCounter, docid) + extension));
-		ec = strus::writeFile( filename, content);
-		if (ec) std::cerr << "error writing file " << filename << ": " << std::strerror(ec) << std::endl;
+		if (g_outputWriter)
+		{
+			g_outputWriter->write( fileCounter, filename, content);
+		}
+		else
+		{
+			ec = strus::writeFile( filename, content);
+			if (ec)
+			{
+				std::cerr << "error writing file " << filename << ": " << std::strerror(ec) << std::endl;
+				addFailedOutputFile( filename);
+			}
+		}
 	}
 }
 
 static void removeWorkFile( int fileCounter, const std::string& docid, const std::string& extension)
 {
-	if (g_dumpStdout || g_doTest) return;
+	if (g_dumpStdout || g_doTest || g_outputArchives) return;
+	//... archives are written from scratch, there are no files of a previous run to remove
 
 	char dirnam[ 16];
 	std::snprintf( dirnam, sizeof(dirnam), "%04u", fileCounter / 1000);
 	int ec;
 
 	std::string filename( strus::joinFilePath( strus::joinFilePath( g_outputdir, dirnam), getFilenameFromDocid( fileCounter, docid) + extension));
-	ec = strus::removeFile( filename, false);
-	if (ec) std::cerr << "error removing file " << filename << ": " << std::strerror(ec) << std::endl;
+	if (g_outputWriter)
+	{
+		g_outputWriter->remove( fileCounter, filename);
+	}
+	else
+	{
+		ec = strus::removeFile( filename, false);
+		if (ec)
+		{
+			std::cerr << "error removing file " << filename << ": " << std::strerror(ec) << std::endl;
+			addFailedOutputFile( filename);
+		}
+	}
+}
+
+/// \brief Notify the checkpoint and the test output that a document has been completed, after its output files have been written
+/// \note Does not throw, as it is also called for documents that failed
+static void notifyCompleted( int fileCounter)
+{
+	try
+	{
+		if (g_testOutput) g_testOutput->completed( fileCounter);
+		if (!g_checkpoint) return;
+		if (g_outputWriter)
+		{
+			g_outputWriter->completed( fileCounter);
+		}
+		else
+		{
+			g_checkpoint->completed( fileCounter);
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "out of memory notifying the completion of document " << fileCounter << std::endl;
+	}
+	catch (const std::runtime_error& err)
+	{
+		std::cerr << "error notifying the completion of document " << fileCounter << ": " << err.what() << std::endl;
+	}
 }
 
 static void writeErrorFile( int fileCounter, const std::string& docid, const std::string& errorstext)
@@ -516,10 +777,40 @@ static void writeLexerDumpFile( int fileCounter, const strus::DocumentStructure&
 	writeWorkFile( fileCounter, doc.fileId(), ".txt", doc.tostring());
 }
 
-static void writeOutputFiles( int fileCounter, const strus::DocumentStructure& doc)
+static void writeOutputFiles( int fileCounter, const strus::DocumentStructure& doc, strus::StageCounters* counters)
 {
-	writeWorkFile( fileCounter, doc.fileId(), ".xml", doc.toxml( g_beautified, g_singleIdAttribute));
+	strus::StageClock clock( counters);
+	std::string output( doc.toxml( g_beautified, g_singleIdAttribute));
+	clock.stop( strus::StageToXml);
+	if (counters) counters->outputBytes += output.size();
+
 	std::string strange = doc.reportStrangeFeatures();
+	std::string errdump;
+	if (!doc.errors().empty())
+	{
+		std::ostringstream errorstext;
+		std::vector<std::string>::const_iterator ei = doc.errors().begin(), ee = doc.errors().end();
+		for (int eidx=1; ei != ee; ++ei,++eidx)
+		{
+			errorstext << "[" << eidx << "] " << *ei << "\n";
+		}
+		errdump = errorstext.str();
+	}
+	std::vector<std::string> unresolved( doc.unresolved());
+	std::string unresolveddump;
+	if (!unresolved.empty())
+	{
+		std::ostringstream unresolvedtext;
+		std::vector<std::string>::const_iterator ei = unresolved.begin(), ee = unresolved.end();
+		for (int eidx=1; ei != ee; ++ei,++eidx)
+		{
+			unresolvedtext << "[" << eidx << "] " << *ei << "\n";
+		}
+		unresolveddump = unresolvedtext.str();
+	}
+	clock.stop( strus::StageReport);
+
+	writeWorkFile( fileCounter, doc.fileId(), ".xml", output);
 	if (strange.empty())
 	{
 		removeWorkFile( fileCounter, doc.fileId(), ".wtf");
@@ -528,50 +819,40 @@ static void writeOutputFiles( int fileCounter, const strus::DocumentStructure& d
 	{
 		writeWorkFile( fileCounter, doc.fileId(), ".wtf", strange);
 	}
-	if (doc.errors().empty())
+	if (errdump.empty())
 	{
 		removeWorkFile( fileCounter, doc.fileId(), ".err");
 	}
 	else
 	{
-		std::ostringstream errorstext;
-		std::vector<std::string>::const_iterator ei = doc.errors().begin(), ee = doc.errors().end();
-		for (int eidx=1; ei != ee; ++ei,++eidx)
-		{
-			errorstext << "[" << eidx << "] " << *ei << "\n";
-		}
-		std::string errdump( errorstext.str());
 		writeWorkFile( fileCounter, doc.fileId(), ".err", errdump);
 		if (g_verbosity >= 1) std::cerr << "got errors:" << std::endl << errdump << std::endl;
 	}
-	std::vector<std::string> unresolved( doc.unresolved());
-	if (unresolved.empty())
+	if (unresolveddump.empty())
 	{
 		removeWorkFile( fileCounter, doc.fileId(), ".mis");
 	}
 	else
 	{
-		std::ostringstream unresolvedtext;
-		std::vector<std::string>::const_iterator ei = unresolved.begin(), ee = unresolved.end();
-		for (int eidx=1; ei != ee; ++ei,++eidx)
-		{
-			unresolvedtext << "[" << eidx << "] " << *ei << "\n";
-		}
-		std::string unresolveddump( unresolvedtext.str());
 		writeWorkFile( fileCounter, doc.fileId(), ".mis", unresolveddump);
 		if (g_verbosity >= 1) std::cerr << "got " << (int)unresolved.size() << " unresolved page links:" << std::endl;
 	}
+	clock.stop( strus::StageWrite);
 }
 
+/// \brief Document to convert, linked with the other documents of its batch
 class Work
 {
 public:
-	Work()
-		:m_writeDumpsAlways(false),m_fileindex(-1),m_title(),m_content(){}
-	Work( int fileindex_, const std::string& title_, const std::string& content_, bool writeDumpsAlways_)
-		:m_writeDumpsAlways(writeDumpsAlways_),m_fileindex(fileindex_),m_title(title_),m_content(content_){}
-	Work( const Work& o)
-		:m_writeDumpsAlways(o.m_writeDumpsAlways),m_fileindex(o.m_fileindex),m_title(o.m_title),m_content(o.m_content){}
+	/// \brief Constructor taking over the title and the content of a document without copying them
+	/// \param[in,out] title_ title of the document, swapped with an empty string
+	/// \param[in,out] content_ content of the document, swapped with an empty string
+	Work( int fileindex_, std::string& title_, std::string& content_, bool writeDumpsAlways_)
+		:m_writeDumpsAlways(writeDumpsAlways_),m_fileindex(fileindex_),m_title(),m_content(),m_next(0)
+	{
+		m_title.swap( title_);
+		m_content.swap( content_);
+	}
 
 	bool empty() const
 	{
@@ -580,17 +861,34 @@ public:
 	int fileindex() const				{return m_fileindex;}
 	const std::string& title() const		{return m_title;}
 	const std::string& content() const		{return m_content;}
+	/// \brief Number of bytes of the title and the content of the document
+	std::size_t size() const			{return m_title.size() + m_content.size();}
+	/// \brief Next document of the same batch or NULL
+	Work* next() const				{return m_next;}
+	void setNext( Work* next_)			{m_next = next_;}
 
-	void process()
+	/// \param[in,out] counters counters of the stages of the conversion (option --stats) or NULL
+	void process( strus::StageCounters* counters)
 	{
 		bool inputFileWritten = false;
+		strus::CpuDeadline deadline( g_docCpuLimitMs);
 		strus::DocumentStructure doc;
 		doc.setTitle( m_title);
+		//... the deadline is polled in the lexer and in the loops building and printing the structure
+		if (g_docCpuLimitMs) doc.setDeadline( &deadline);
+		if (counters)
+		{
+			++counters->documents;
+			counters->bytes += m_content.size();
+		}
 		try
 		{
-			parseDocumentText( doc, m_content.c_str(), m_content.size());
+			parseDocumentText( doc, m_content.c_str(), m_content.size(), counters, g_docCpuLimitMs ? &deadline : NULL);
+			strus::StageClock clock( counters);
 			doc.finish();
-			writeOutputFiles( m_fileindex, doc);
+			clock.stop( strus::StageFinish);
+			if (counters) counters->paragraphs += doc.nofParagraphs();
+			writeOutputFiles( m_fileindex, doc, counters);
 			if (m_writeDumpsAlways || !doc.errors().empty())
 			{
 				writeLexerDumpFile( m_fileindex, doc);
@@ -601,169 +899,983 @@ public:
 				}
 			}
 		}
+		catch (const strus::CpuDeadlineExceededException& err)
+		{
+			doc.setDeadline( NULL);
+			addTimedOutDocument( m_title, doc.fileId());
+			writeFatalError( doc, err.what(), inputFileWritten);
+		}
 		catch (const std::runtime_error& err)
 		{
-			writeLexerDumpFile( m_fileindex, doc);
-			writeErrorFile( m_fileindex, doc.fileId(), err.what());
-			writeFatalErrorFile( m_fileindex, doc.fileId(), std::string(err.what()) + "\n");
-			if (!inputFileWritten)
-			{
-				writeInputFile( m_fileindex, doc.fileId(), m_title, m_content);
-				inputFileWritten = true;
-			}
+			writeFatalError( doc, err.what(), inputFileWritten);
+		}
+	}
+
+private:
+	void writeFatalError( const strus::DocumentStructure& doc, const char* msg, bool inputFileWritten)
+	{
+		writeLexerDumpFile( m_fileindex, doc);
+		writeErrorFile( m_fileindex, doc.fileId(), msg);
+		writeFatalErrorFile( m_fileindex, doc.fileId(), std::string(msg) + "\n");
+		if (!inputFileWritten)
+		{
+			writeInputFile( m_fileindex, doc.fileId(), m_title, m_content);
 		}
 	}
 
+private:
+	Work( const Work&);		//... non copyable
+	void operator=( const Work&);	//... non copyable
+
 private:
 	bool m_writeDumpsAlways;
 	int m_fileindex;
 	std::string m_title;
 	std::string m_content;
+	Work* m_next;
 };
 
-class Worker
+/// \brief Documents handed over to a worker at once, to amortize the costs of the hand-off for small documents (options --batchdocs, --batchkb)
+/// \remark The documents are a list linked by Work::next, the list is passed through the queues without any container allocated for it.
+class WorkBatch
 {
 public:
-	Worker()
-		:m_thread(0),m_threadid(0),m_terminated(false),m_eof(false),m_writeDumpsAlways(g_dumps){}
-	~Worker()
+	WorkBatch()
+		:m_first(0),m_last(0),m_nofDocs(0),m_size(0){}
+	/// \brief Constructor of a batch passed through a queue as its first document
+	explicit WorkBatch( Work* first_)
+		:m_first(first_),m_last(0),m_nofDocs(0),m_size(0)
 	{
-		waitTermination();
+		for (Work* wi = first_; wi; wi = wi->next())
+		{
+			m_last = wi;
+			++m_nofDocs;
+			m_size += wi->size();
+		}
 	}
 
-	void push( int filecounter, const std::string& title, const std::string& content)
+	/// \brief Append a document, the batch takes the ownership
+	void add( Work* work)
 	{
-		strus::unique_lock lock( m_queue_mutex);
-		m_queue.push( Work( filecounter, title, content, m_writeDumpsAlways));
-		m_cv.notify_one();
+		if (m_last) m_last->setNext( work); else m_first = work;
+		m_last = work;
+		++m_nofDocs;
+		m_size += work->size();
 	}
-	void terminate()
+	/// \brief Get the first document of the linked list and reset the batch to empty, the caller takes the ownership
+	Work* release()
 	{
-		m_terminated.set( true);
-		m_cv.notify_all();
+		Work* rt = m_first;
+		m_first = m_last = 0;
+		m_nofDocs = 0;
+		m_size = 0;
+		return rt;
 	}
-	void waitTermination()
+	/// \brief Delete the documents of a linked list
+	static void destroy( Work* first)
 	{
-		if (m_thread)
+		while (first)
 		{
-			m_eof.set( true);
-			m_cv.notify_all();
-			m_thread->join();
-			delete m_thread;
-			m_thread = 0;
-			if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d terminated\n", m_threadid) << std::flush;
+			Work* next = first->next();
+			delete first;
+			first = next;
 		}
 	}
-	void waitSignal()
+
+	bool empty() const				{return !m_first;}
+	int nofDocs() const				{return m_nofDocs;}
+	/// \brief Number of bytes of titles and contents of the documents in the batch
+	std::size_t size() const			{return m_size;}
+
+private:
+	Work* m_first;
+	Work* m_last;
+	int m_nofDocs;
+	std::size_t m_size;
+};
+
+/// \brief Queue of batches of documents with one thread pushing and any thread fetching, without locks
+/// \remark A ring of pointers to batches with a producer index (tail) and a consumer index (head) incremented with compare and swap.
+///	The producer only writes slots released by the consumers, a consumer reading a slot overwritten concurrently fails to increment the head and retries.
+class WorkQueue
+{
+public:
+	enum {Size=1024};
+
+	WorkQueue()
+		:m_head(0),m_tail(0),m_slots(new Slot[ Size]){}
+	~WorkQueue()
+	{
+		Work* batch;
+		while (0!=(batch = fetch())) WorkBatch::destroy( batch);
+		delete [] m_slots;
+	}
+
+	/// \brief Push a batch as its first document (only called by the single producer)
+	/// \return false if the queue is full
+	bool push( Work* batch)
 	{
-		strus::unique_lock lock( m_cv_mutex);
-		m_cv.wait( lock);
+		std::size_t tail = m_tail.load();
+		if (tail - m_head.load() >= (std::size_t)Size) return false;
+		m_slots[ tail % Size].ptr.store( batch);
+		m_tail.store( tail + 1);
+		return true;
 	}
-	bool fetch( Work& work)
+	/// \brief Fetch the oldest batch (called by any thread)
+	/// \return the first document of the batch or NULL if the queue is empty
+	Work* fetch()
 	{
-		strus::unique_lock lock( m_queue_mutex);
-		if (m_queue.empty())
+		for (;;)
 		{
-			if (m_eof.test())
-			{
-				m_terminated.set( true);
-			}
-			return false;
-		}
-		else
-		{
-			work = m_queue.front();
-			m_queue.pop();
-			return true;
+			std::size_t head = m_head.load();
+			if (head == m_tail.load()) return 0;
+			Work* rt = m_slots[ head % Size].ptr.load();
+			if (m_head.compare_exchange_strong( head, head + 1)) return rt;
 		}
 	}
+	bool empty() const
+	{
+		return m_head.load() == m_tail.load();
+	}
 
-	void run()
+private:
+	struct Slot
 	{
-		if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d started\n", m_threadid) << std::flush;
-		while (!m_terminated.test())
+		strus::atomic<Work*> ptr;
+		Slot() :ptr(0){}
+	};
+	//... all atomic operations with the default sequentially consistent memory order
+	strus::atomic<std::size_t> m_head;
+	strus::atomic<std::size_t> m_tail;
+	Slot* m_slots;
+};
+
+class Worker;
+
+/// \brief Tell the CPU that the calling thread is in a busy wait loop, releasing resources to the other hyperthread of the core
+static inline void cpuRelax()
+{
+#if defined(__SSE2__)
+	_mm_pause();
+#endif
+}
+
+/// \brief State shared by the workers of a conversion for waking idle workers and stealing work from each other
+/// \remark Documents are pushed to the queue of a worker, an idle worker takes documents from the queues of other workers if its own is empty.
+///	An idle worker first spins on the queues for a while (pausing, later yielding the CPU) and then parks on a condition variable. The producer takes the lock
+///	of the condition only if there are workers parked, the counter of parked workers is incremented before the queues
+///	are checked the last time before parking, so no wakeup can get lost.
+///	The number of documents and bytes queued is bounded, a document not fitting into the queues is processed by the scanner itself.
+///	The limits are exact also with several scanners (option --shards), a reservation is only made if it fits (compare and swap).
+class WorkerGroup
+{
+public:
+	WorkerGroup()
+		:m_workers(0),m_nofWorkers(0),m_mutex(),m_cv(),m_nofParked(0),m_eof(false)
+		,m_maxQueuedDocs(0),m_maxQueuedBytes(0),m_nofQueuedDocs(0),m_nofQueuedBytes(0),m_nofRejected(0){}
+	/// \param[in] workers_ array of workers
+	/// \param[in] nofWorkers_ number of workers
+	/// \param[in] maxQueuedDocs_ maximum number of documents queued or 0 for no limit
+	/// \param[in] maxQueuedBytes_ maximum number of bytes of documents queued or 0 for no limit
+	void init( Worker* workers_, int nofWorkers_, int maxQueuedDocs_, std::size_t maxQueuedBytes_)
+	{
+		m_workers = workers_;
+		m_nofWorkers = nofWorkers_;
+		m_maxQueuedDocs = maxQueuedDocs_;
+		m_maxQueuedBytes = maxQueuedBytes_;
+	}
+
+	Worker* workers() const		{return m_workers;}
+	int nofWorkers() const		{return m_nofWorkers;}
+
+	/// \brief Reserve space in the queues for a batch of documents to push
+	/// \param[in] nofDocs number of documents in the batch
+	/// \param[in] size number of bytes of the documents in the batch
+	/// \return false if the queues are full
+	/// \note A batch exceeding the limits alone is accepted if the queues are empty
+	bool reserve( int nofDocs, std::size_t size)
+	{
+		int nofQueuedDocs;
+		do
 		{
-			std::string title;
-			try
-			{
-				waitSignal();
-				Work work;
-				while (fetch( work))
-				{
-					title = work.title();
-					if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d process document '%s'\n", m_threadid, title.c_str()) << std::flush;
-					work.process();
-				}
-			}
-			catch (const std::bad_alloc&)
+			nofQueuedDocs = m_nofQueuedDocs.value();
+			if (nofQueuedDocs > 0 && m_maxQueuedDocs && nofQueuedDocs + nofDocs > m_maxQueuedDocs)
 			{
-				std::cerr << "out of memory processing document " << title << std::endl;
+				m_nofRejected.increment( nofDocs);
+				return false;
 			}
-			catch (const std::runtime_error& err)
+		}
+		while (!m_nofQueuedDocs.test_and_set( nofQueuedDocs, nofQueuedDocs + nofDocs));
+		std::size_t nofQueuedBytes;
+		do
+		{
+			nofQueuedBytes = m_nofQueuedBytes.value();
+			if (nofQueuedDocs > 0 && m_maxQueuedBytes && nofQueuedBytes + size > m_maxQueuedBytes)
 			{
-				std::cerr << "error processing document " << title << ": " << err.what() << std::endl;
+				//... undo the reservation of the documents
+				m_nofQueuedDocs.decrement( nofDocs);
+				m_nofRejected.increment( nofDocs);
+				return false;
 			}
 		}
+		while (!m_nofQueuedBytes.test_and_set( nofQueuedBytes, nofQueuedBytes + size));
+		return true;
 	}
-	void start( int threadid_)
+	/// \brief Release the space reserved for a batch of documents fetched from a queue or not pushed
+	void release( int nofDocs, std::size_t size)
 	{
-		m_threadid = threadid_;
-		if (m_thread) throw std::runtime_error("start called twice");
-		m_thread = new strus::thread( &Worker::run, this);
+		m_nofQueuedDocs.decrement( nofDocs);
+		m_nofQueuedBytes.decrement( size);
+	}
+	/// \brief Count documents held by a scanner before dispatching them (option --window) against the limit of bytes queued
+	void hold( std::size_t size)
+	{
+		m_nofQueuedBytes.increment( size);
+	}
+	/// \brief Release documents held by a scanner, before dispatching them
+	void unhold( std::size_t size)
+	{
+		m_nofQueuedBytes.decrement( size);
+	}
+	/// \brief Maximum number of bytes of documents queued or 0 for no limit
+	std::size_t maxQueuedBytes() const	{return m_maxQueuedBytes;}
+	/// \brief Number of documents processed by the scanner because the queues were full
+	int nofRejected() const			{return m_nofRejected.value();}
+
+	/// \brief Notify that a document has been pushed into a queue
+	void notifyWork()
+	{
+		if (m_nofParked.load() > 0)
+		{
+			strus::unique_lock lock( m_mutex);
+			m_cv.notify_one();
+		}
+	}
+	/// \brief Notify that no more documents are pushed
+	void notifyEof()
+	{
+		strus::unique_lock lock( m_mutex);
+		m_eof.set( true);
+		m_cv.notify_all();
+	}
+	bool eof()
+	{
+		return m_eof.test();
 	}
+	/// \brief Park a worker until documents are pushed or the end of input is notified
+	/// \param[in] worker the worker parked, checks the queues after it is counted as parked
+	void park( Worker& worker);
 
 private:
+	Worker* m_workers;
+	int m_nofWorkers;
+	strus::mutex m_mutex;
 	strus::condition_variable m_cv;
-	strus::mutex m_cv_mutex;
-	strus::mutex m_queue_mutex;
-	std::queue<Work> m_queue;
-	strus::thread* m_thread;
-	int m_threadid;
-	strus::AtomicFlag m_terminated;
+	strus::atomic<int> m_nofParked;		//... sequentially consistent with the queue indices
 	strus::AtomicFlag m_eof;
-	bool m_writeDumpsAlways;
+	int m_maxQueuedDocs;
+	std::size_t m_maxQueuedBytes;
+	strus::AtomicCounter<int> m_nofQueuedDocs;
+	strus::AtomicCounter<std::size_t> m_nofQueuedBytes;
+	strus::AtomicCounter<int> m_nofRejected;
 };
 
-class IStream
-	:public textwolf::IStream
+class Worker
 {
 public:
-	explicit IStream( const std::string& docpath)
-		:m_impl(docpath)
+	enum {SpinCount=1000,SpinPauseCount=100};
+	//... idle worker polls the queues SpinCount times before parking, the first SpinPauseCount times with a pause, then yielding the CPU
+
+	Worker()
+		:m_queue(),m_thread(0),m_threadid(0),m_group(0),m_nofStolen(0),m_lastFinishTime(0.0),m_counters(){}
+	~Worker()
 	{
-		int ec = m_impl.error();
-		if (ec) throw std::runtime_error( strus::string_format("failed to read input file '%s': %s", docpath.c_str(), ::strerror(ec)));
+		waitTermination();
 	}
-	virtual ~IStream(){}
 
-	virtual std::size_t read( void* buf, std::size_t bufsize)
+	/// \brief Push a batch of documents into the queue of this worker (only called by one scanner thread)
+	/// \return true if the batch is queued and owned by the worker (the batch is reset to empty), false if the queues are full and the caller has to process the documents
+	bool push( WorkBatch& batch)
 	{
-		return m_impl.read( (char*)buf, bufsize);
+		if (!m_group->reserve( batch.nofDocs(), batch.size())) return false;
+		Work* first = batch.release();
+		if (!m_queue.push( first))
+		{
+			batch = WorkBatch( first);
+			m_group->release( batch.nofDocs(), batch.size());
+			return false;
+		}
+		m_group->notifyWork();
+		return true;
 	}
-
-	virtual int errorcode() const
+	void waitTermination()
 	{
-		return m_impl.error();
+		if (m_thread)
+		{
+			m_group->notifyEof();
+			m_thread->join();
+			delete m_thread;
+			m_thread = 0;
+			if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d terminated\n", m_threadid) << std::flush;
+		}
 	}
+	/// \brief Group of workers this worker belongs to
+	WorkerGroup* group() const		{return m_group;}
+	/// \brief Number of documents taken from the queues of other workers
+	int nofStolen() const			{return m_nofStolen;}
+	/// \brief Time when the last document was finished by this worker
+	double lastFinishTime() const		{return m_lastFinishTime;}
 
-private:
-	strus::InputStream m_impl;
-};
-
-static int getUIntOptionArg( int argi, int argc, const char* argv[])
-{
-	if (argv[argi+1])
+	/// \brief Evaluate if any worker of the group has documents queued
+	bool workAvailable() const
 	{
-		return strus::numstring_conv::touint( argv[argi+1], std::numeric_limits<int>::max());
+		Worker* workers = m_group->workers();
+		int nofWorkers = m_group->nofWorkers();
+		for (int wi=0; wi < nofWorkers; ++wi)
+		{
+			if (!workers[ wi].m_queue.empty()) return true;
+		}
+		return false;
+	}
+
+	void run()
+	{
+		bindThread( nofScannerThreads() + m_threadid - 1);
+		if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d started\n", m_threadid) << std::flush;
+		for (;;)
+		{
+			Work* batch = fetchAny();
+			for (int spin=0; !batch && spin < SpinCount; ++spin)
+			{
+				if (spin < SpinPauseCount)
+				{
+					cpuRelax();
+				}
+				else
+				{
+					::sched_yield();
+				}
+				if (workAvailable()) batch = fetchAny();
+			}
+			if (!batch)
+			{
+				if (m_group->eof())
+				{
+					//... the scanner pushes nothing after notifying the end of input
+					batch = fetchAny();
+					if (!batch) break;
+				}
+				else
+				{
+					m_group->park( *this);
+					continue;
+				}
+			}
+			while (batch)
+			{
+				Work& work = *batch;
+				try
+				{
+					if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d process document '%s'\n", m_threadid, work.title().c_str()) << std::flush;
+					work.process( g_statistics ? &m_counters : NULL);
+				}
+				catch (const std::bad_alloc&)
+				{
+					std::cerr << "out of memory processing document " << work.title() << std::endl;
+				}
+				catch (const std::runtime_error& err)
+				{
+					std::cerr << "error processing document " << work.title() << ": " << err.what() << std::endl;
+				}
+				//... also if the document failed, the checkpoint would not advance past it otherwise
+				notifyCompleted( work.fileindex());
+				if (g_statistics) g_statistics->add( nofScannerThreads() + m_threadid - 1, m_counters);
+				batch = work.next();
+				delete &work;
+			}
+			m_lastFinishTime = strus::monotonicTimeSeconds();
+		}
+	}
+	void start( int threadid_, WorkerGroup* group_)
+	{
+		m_threadid = threadid_;
+		m_group = group_;
+		if (m_thread) throw std::runtime_error("start called twice");
+		m_thread = new strus::thread( &Worker::run, this);
+	}
+
+private:
+	/// \brief Fetch a batch of documents from the own queue
+	/// \param[out] nofDocs number of documents in the batch fetched
+	/// \return the first document of the batch or NULL if the queue is empty
+	Work* fetch( int& nofDocs)
+	{
+		Work* rt = m_queue.fetch();
+		if (rt)
+		{
+			WorkBatch batch( rt);
+			nofDocs = batch.nofDocs();
+			m_group->release( nofDocs, batch.size());
+		}
+		return rt;
+	}
+	/// \brief Fetch a batch of documents from the own queue or from the queue of another worker
+	/// \return the first document of the batch or NULL if all queues are empty
+	Work* fetchAny()
+	{
+		int nofDocs;
+		Work* rt = fetch( nofDocs);
+		if (rt) return rt;
+		Worker* workers = m_group->workers();
+		int nofWorkers = m_group->nofWorkers();
+		int ownidx = this - workers;
+		for (int wi=1; wi < nofWorkers; ++wi)
+		{
+			rt = workers[ (ownidx + wi) % nofWorkers].fetch( nofDocs);
+			if (rt)
+			{
+				//... the oldest batch is taken, to keep the processing roughly in the order of the input
+				m_nofStolen += nofDocs;
+				return rt;
+			}
+		}
+		return 0;
+	}
+
+private:
+	WorkQueue m_queue;
+	strus::thread* m_thread;
+	int m_threadid;
+	WorkerGroup* m_group;
+	int m_nofStolen;
+	double m_lastFinishTime;
+	strus::StageCounters m_counters;		//... counters of the document processed (option --stats)
+};
+
+void WorkerGroup::park( Worker& worker)
+{
+	strus::unique_lock lock( m_mutex);
+	m_nofParked.fetch_add( 1);
+	if (!m_eof.test() && !worker.workAvailable())
+	{
+		m_cv.wait( lock);
+	}
+	m_nofParked.fetch_sub( 1);
+}
+
+class IStream
+	:public textwolf::IStream
+{
+public:
+	explicit IStream( const std::string& docpath)
+		:m_impl(docpath)
+	{
+		int ec = m_impl.error();
+		if (ec) throw std::runtime_error( strus::string_format("failed to read input file '%s': %s", docpath.c_str(), ::strerror(ec)));
+	}
+	virtual ~IStream(){}
+
+	virtual std::size_t read( void* buf, std::size_t bufsize)
+	{
+		return m_impl.read( (char*)buf, bufsize);
+	}
+
+	virtual int errorcode() const
+	{
+		return m_impl.error();
+	}
+
+private:
+	strus::InputStream m_impl;
+};
+
+static void skipInput( textwolf::IStream& input, textwolf::PositionIndex size)
+{
+	std::vector<char> buf( 1<<20);
+	while (size > 0)
+	{
+		std::size_t nn = input.read( &buf[0], size > buf.size() ? buf.size() : (std::size_t)size);
+		if (input.errorcode()) throw std::runtime_error( strus::string_format( "failed to read input: %s", ::strerror( input.errorcode())));
+		if (nn == 0) throw std::runtime_error( "checkpoint offset is beyond the end of the input");
+		size -= nn;
+	}
+}
+
+static int getUIntOptionArg( int argi, int argc, const char* argv[])
+{
+	if (argv[argi+1])
+	{
+		return strus::numstring_conv::touint( argv[argi+1], std::numeric_limits<int>::max());
 	}
 	else
 	{
 		throw std::runtime_error( std::string("no argument given for option ") + argv[argi]);
 	}
-}
-
-enum TagId {TagIgnored,TagPage,TagNs,TagTitle,TagText,TagRedirect};
+}
+
+typedef strus::PageAttributes DocAttributes;
+
+/// \brief Document buffered for dispatching it ordered by size (option --window)
+struct PendingDocument
+{
+	int docIndex;
+	std::string title;
+	std::string content;
+
+	PendingDocument()
+		:docIndex(0),title(),content(){}
+	PendingDocument( const PendingDocument& o)
+		:docIndex(o.docIndex),title(o.title),content(o.content){}
+};
+
+/// \brief Order of indices of pending documents with the largest content first
+struct PendingDocumentLargerContent
+{
+	explicit PendingDocumentLargerContent( const std::vector<PendingDocument>& docs_)
+		:docs(&docs_){}
+	bool operator()( std::size_t aa, std::size_t bb) const
+	{
+		return (*docs)[ aa].content.size() > (*docs)[ bb].content.size();
+	}
+	const std::vector<PendingDocument>* docs;
+};
+
+class DumpScanner
+{
+public:
+	/// \brief Constructor
+	/// \param[in] workers_ array of workers the documents are distributed to, documents are processed in the scanner thread if empty
+	/// \param[in] nofWorkers_ size of array of workers
+	/// \param[in] linkmapBuilder_ link map builder for collecting redirects (option -R)
+	/// \param[in] shardIndex_ index of the part of the input scanned by this scanner (0 if not sharded)
+	/// \param[in] nofShards_ number of parts of the input scanned in parallel (1 if not sharded)
+	/// \note Documents of shard k are numbered k, k+nofShards, k+2*nofShards, ... to keep the numbering deterministic
+	DumpScanner( Worker* workers_, int nofWorkers_, strus::LinkMapBuilder* linkmapBuilder_, int shardIndex_, int nofShards_)
+		:m_workers(workers_),m_nofWorkers(nofWorkers_),m_linkmapBuilder(linkmapBuilder_)
+		,m_shardIndex(shardIndex_),m_nofShards(nofShards_),m_docCounter(g_checkpoint ? g_checkpoint->startDocno() : 0)
+		,m_outputDirIndex(-1),m_outputDirs(),m_window(),m_windowSize(0),m_batch(),m_batchCounter(0),m_pageOffset(0),m_inputOffset(0)
+		,m_counters(),m_scanTime(0)
+	{
+		//... no reallocation of the window, that would copy the documents
+		if (m_nofWorkers && g_scheduleWindow > 1) m_window.reserve( g_scheduleWindow);
+	}
+	~DumpScanner()
+	{
+		WorkBatch::destroy( m_batch.release());
+	}
+
+	int docCounter() const
+	{
+		return m_docCounter;
+	}
+
+	/// \brief Scan the pages of a dump with the generic XML scanner
+	/// \param[in] inputiterator input iterator
+	/// \param[in] inputOffset offset of the input start in the dump (for checkpoints)
+	template <class InputIterator>
+	void run( const InputIterator& inputiterator, textwolf::PositionIndex inputOffset)
+	{
+		bindThread( m_shardIndex);
+		if (g_statistics) m_scanTime = strus::StageCounters::now();
+		m_inputOffset = inputOffset;
+		strus::scanPagesXml( inputiterator, *this, g_pageFilter, g_verbosity >= 2);
+		dispatchWindow();
+		dispatchBatch();
+	}
+
+	/// \brief Scan the pages of a dump in contiguous memory with the fast page extractor, using the generic XML scanner only for pages it can not handle
+	void runFast( const char* begin, const char* end, textwolf::PositionIndex inputOffset)
+	{
+		bindThread( m_shardIndex);
+		if (g_statistics) m_scanTime = strus::StageCounters::now();
+		strus::PageExtractor extractor( begin, end, g_pageFilter);
+		DocAttributes docAttributes;
+		for (;;)
+		{
+			strus::PageExtractor::Result res = extractor.next( docAttributes);
+			if (res == strus::PageExtractor::EndOfInput)
+			{
+				break;
+			}
+			else if (res == strus::PageExtractor::Anomaly)
+			{
+				if (g_verbosity >= 1) std::cerr << strus::string_format( "using XML scanner for page at offset %lu\n", (unsigned long)(extractor.pagestart() - begin)) << std::flush;
+				m_inputOffset = inputOffset + (extractor.pagestart() - begin);
+				strus::scanPagesXml( strus::MemoryInputIterator( extractor.pagestart(), extractor.pageend()), *this, g_pageFilter, g_verbosity >= 2);
+			}
+			else
+			{
+				m_inputOffset = inputOffset;
+				openPage( extractor.pagestart() - begin);
+				closePage( docAttributes);
+			}
+		}
+		dispatchWindow();
+		dispatchBatch();
+	}
+
+	void openPage( std::size_t position)
+	{
+		m_pageOffset = m_inputOffset + position;
+	}
+
+	/// \remark The content of the page may be taken over (swapped) by the scanner
+	void closePage( DocAttributes& docAttributes)
+	{
+		if (g_statistics)
+		{
+			//... the time since the last page closed is spent for scanning the input
+			m_counters.ns[ strus::StageScan] += strus::StageCounters::now() - m_scanTime;
+			++m_counters.pages;
+			handlePage( docAttributes);
+			g_statistics->add( m_shardIndex, m_counters);
+			if (m_shardIndex == 0) g_statistics->tick();
+			m_scanTime = strus::StageCounters::now();
+		}
+		else
+		{
+			handlePage( docAttributes);
+		}
+	}
+
+private:
+	void handlePage( DocAttributes& docAttributes)
+	{
+		if (g_pageFilter && !g_pageFilter->match( docAttributes))
+		{
+			//... ignore document but those with ns set to what is selected by option '-n' and title matching option '-S'
+			return;
+		}
+		if (!docAttributes.redirect_title.empty() && docAttributes.content.size() < 1000)
+		{
+			// ... is as Redirect
+			if (g_collectRedirects)
+			{
+				++m_docCounter;
+				std::pair<std::string,std::string> redir_parts = strus::LinkMap::getLinkParts( docAttributes.redirect_title);
+				if (g_verbosity >= 1) std::cerr << strus::string_format( "%s => %s\n", docAttributes.title.c_str(), docAttributes.redirect_title.c_str());
+				m_linkmapBuilder->redirect( docAttributes.title, redir_parts.first);
+
+				if (g_counterMod && g_verbosity == 0 && m_docCounter % g_counterMod == 0)
+				{
+					std::cerr << "processed " << m_docCounter << " documents" << std::endl;
+				}
+			}
+		}
+		else if (!docAttributes.title.empty() && !docAttributes.content.empty())
+		{
+			// ... is as Document
+			if (g_collectRedirects)
+			{
+				++m_docCounter;
+				if (g_verbosity >= 1) std::cerr << strus::string_format( "link %s => %s\n", docAttributes.title.c_str(), docAttributes.title.c_str());
+				m_linkmapBuilder->define( docAttributes.title);
+
+				if (g_counterMod && g_verbosity == 0 && m_docCounter % g_counterMod == 0)
+				{
+					std::cerr << "processed " << m_docCounter << " documents" << std::endl;
+				}
+			}
+			else
+			{
+				if (!g_dumpfilename.empty())
+				{
+					int ec = strus::writeFile( g_dumpfilename, docAttributes.content);
+					if (ec) std::cerr << "failed to write dump file " << g_dumpfilename << ": " << ::strerror(ec) << std::endl;
+				}
+				int docIndex = getDocIndex( docAttributes);
+				if (docIndex < 0)
+				{
+					std::cerr << "missing or invalid page id of document '" << docAttributes.title << "'" << std::endl;
+					addSkippedDocument( docAttributes.title);
+					return;
+				}
+				++m_docCounter;
+				prepareOutputDir( docIndex);
+				bool unchanged = false;
+				if (g_manifest)
+				{
+					std::string filename = getWorkFileName( docIndex, strus::DocumentStructure::getFileId( docAttributes.title), ".xml");
+					unchanged = strus::Manifest::Unchanged == g_manifest->add( docAttributes.title, docAttributes.revision_id, docAttributes.sha1, filename);
+				}
+				if (g_checkpoint)
+				{
+					g_checkpoint->dispatched( docIndex, m_pageOffset);
+				}
+				if (g_testOutput)
+				{
+					g_testOutput->dispatched( docIndex);
+				}
+				if (g_checkpoint && g_checkpoint->completedBefore( docIndex))
+				{
+					//... document written by the interrupted run resumed
+					g_checkpoint->completed( docIndex);
+				}
+				else if (unchanged)
+				{
+					//... revision converted by the run of the previous manifest (option --incremental)
+					if (g_verbosity >= 1) std::cerr << strus::string_format( "skip unchanged document '%s'\n", docAttributes.title.c_str()) << std::flush;
+				}
+				else if (m_nofWorkers && g_scheduleWindow > 1)
+				{
+					//... dispatched with the other documents of the window, largest first (option --window)
+					m_window.push_back( PendingDocument());
+					m_window.back().docIndex = docIndex;
+					m_window.back().title.swap( docAttributes.title);
+					m_window.back().content.swap( docAttributes.content);
+					std::size_t size = m_window.back().content.size();
+					m_windowSize += size;
+					m_workers[0].group()->hold( size);
+
+					std::size_t maxWindowSize = m_workers[0].group()->maxQueuedBytes();
+					if ((int)m_window.size() >= g_scheduleWindow || (maxWindowSize && m_windowSize >= maxWindowSize))
+					{
+						dispatchWindow();
+					}
+				}
+				else
+				{
+					dispatch( docIndex, docAttributes.title, docAttributes.content);
+				}
+				if (g_counterMod && g_verbosity == 0 && m_docCounter % g_counterMod == 0)
+				{
+					std::cerr << "processed " << m_docCounter << " documents" << std::endl;
+				}
+				if (g_checkpoint) g_checkpoint->tick();
+			}
+		}
+		else if (docAttributes.content.empty())
+		{
+			std::cerr << "empty document '" << docAttributes.title << "'" << std::endl;
+		}
+		else
+		{
+			std::cerr << "invalid document '" << docAttributes.title << "'" << std::endl;
+		}
+	}
+
+	/// \brief Dispatch a document for conversion
+	/// \param[in,out] title title of the document, taken over (swapped with an empty string)
+	/// \param[in,out] content content of the document, taken over (swapped with an empty string)
+	void dispatch( int docIndex, std::string& title, std::string& content)
+	{
+		if (m_nofWorkers)
+		{
+			//... collect the document in the current batch, passed to the workers when full (options --batchdocs, --batchkb)
+			m_batch.add( new Work( docIndex, title, content, g_dumps));
+			if (m_batch.nofDocs() >= g_batchDocs || m_batch.size() >= (std::size_t)g_batchKB * 1024)
+			{
+				dispatchBatch();
+			}
+		}
+		else
+		{
+			//... no workers, the scanner processes the document itself
+			Work work( docIndex, title, content, g_dumps);
+			process( work);
+		}
+	}
+
+	/// \brief Pass the current batch of documents to the next worker or process it in the scanner thread if the queues are full
+	void dispatchBatch()
+	{
+		if (m_batch.empty()) return;
+		if (m_workers[ m_batchCounter++ % m_nofWorkers].push( m_batch))
+		{
+			//... batch queued for the workers
+			return;
+		}
+		Work* batch = m_batch.release();
+		try
+		{
+			while (batch)
+			{
+				process( *batch);
+				Work* next = batch->next();
+				delete batch;
+				batch = next;
+			}
+		}
+		catch (...)
+		{
+			WorkBatch::destroy( batch);
+			throw;
+		}
+	}
+
+	void process( Work& work)
+	{
+		try
+		{
+			if (g_verbosity >= 1) std::cerr << strus::string_format( "process document '%s'\n", work.title().c_str()) << std::flush;
+			work.process( g_statistics ? &m_counters : NULL);
+		} 
+		catch (const std::bad_alloc&)
+		{
+			std::cerr << "out of memory processing document " << work.title() << std::endl;
+		}
+		catch (const std::runtime_error& err)
+		{
+			std::cerr << "error processing document " << work.title() << ": " << err.what() << std::endl;
+		}
+		//... also if the document failed, the checkpoint would not advance past it otherwise
+		notifyCompleted( work.fileindex());
+	}
+
+	/// \brief Dispatch the documents of the window ordered by content size, largest first
+	void dispatchWindow()
+	{
+		if (m_window.empty()) return;
+		m_workers[0].group()->unhold( m_windowSize);
+		m_windowSize = 0;
+
+		std::vector<std::size_t> order;
+		order.reserve( m_window.size());
+		for (std::size_t wi=0; wi < m_window.size(); ++wi) order.push_back( wi);
+		std::stable_sort( order.begin(), order.end(), PendingDocumentLargerContent( m_window));
+		std::vector<std::size_t>::const_iterator oi = order.begin(), oe = order.end();
+		for (; oi != oe; ++oi)
+		{
+			PendingDocument& doc = m_window[ *oi];
+			dispatch( doc.docIndex, doc.title, doc.content);
+		}
+		m_window.clear();
+	}
+
+	/// \brief Get the number of a document determining its output directory (option --numbering)
+	/// \return the document number or -1 if the page id is missing or invalid
+	int getDocIndex( const DocAttributes& docAttributes) const
+	{
+		switch (g_docNumbering)
+		{
+			case NumberByOrder:
+				return m_docCounter * m_nofShards + m_shardIndex;
+			case NumberByPageId:
+			{
+				strus::NumParseError err;
+				unsigned long long pageid = strus::uintFromString( docAttributes.page_id, std::numeric_limits<int>::max(), err);
+				return err != strus::NumParseOk ? -1 : (int)pageid;
+			}
+			case NumberByTitleHash:
+				return getTitleHashDocIndex( docAttributes.title);
+		}
+		return -1;
+	}
+
+	void prepareOutputDir( int docIndex)
+	{
+		if (docIndex / 1000 != m_outputDirIndex && !g_dumpStdout && !g_doTest && !g_outputArchives)
+		{
+			if (m_outputDirs.insert( docIndex / 1000).second)
+			{
+				createOutputDir( docIndex);
+			}
+			m_outputDirIndex = docIndex / 1000;
+		}
+	}
+
+private:
+	Worker* m_workers;
+	int m_nofWorkers;
+	strus::LinkMapBuilder* m_linkmapBuilder;
+	int m_shardIndex;
+	int m_nofShards;
+	int m_docCounter;
+	int m_outputDirIndex;
+	std::set<int> m_outputDirs;			//... output directories created by this scanner
+	std::vector<PendingDocument> m_window;		//... documents not dispatched yet (option --window)
+	std::size_t m_windowSize;			//... size of the contents of the documents in the window, counted as queued (option --queuemb)
+	WorkBatch m_batch;				//... batch of documents not passed to the workers yet
+	int m_batchCounter;				//... number of batches passed, for distributing them round robin to the workers
+	textwolf::PositionIndex m_pageOffset;		//... offset of the current page in the dump
+	textwolf::PositionIndex m_inputOffset;		//... offset of the input scanned in the dump
+	strus::StageCounters m_counters;		//... counters of the page processed (option --stats)
+	unsigned long long m_scanTime;			//... start time of scanning the current page (option --stats)
+};
+
+/// \brief Scanner thread processing a part of a memory mapped dump starting with a page
+class ShardScanner
+{
+public:
+	ShardScanner( Worker* workers_, int nofWorkers_, int shardIndex_, int nofShards_, const char* begin_, const char* end_)
+		:m_scanner( workers_, nofWorkers_, NULL/*linkmapBuilder*/, shardIndex_, nofShards_)
+		,m_shardIndex(shardIndex_),m_begin(begin_),m_end(end_),m_thread(0),m_error(){}
+	~ShardScanner()
+	{
+		waitTermination();
+	}
+
+	void start()
+	{
+		if (m_thread) throw std::runtime_error("start called twice");
+		m_thread = new strus::thread( &ShardScanner::run, this);
+	}
+	void waitTermination()
+	{
+		if (m_thread)
+		{
+			m_thread->join();
+			delete m_thread;
+			m_thread = 0;
+		}
+	}
+	const std::string& error() const
+	{
+		return m_error;
+	}
+	int docCounter() const
+	{
+		return m_scanner.docCounter();
+	}
+
+	/// \brief Get the start of the next page at or after a position
+	static const char* alignToPage( const char* pos, const char* end)
+	{
+		static const char pagetag[] = "<page>";
+		enum {pagetaglen = sizeof(pagetag)-1};
+		for (;;)
+		{
+			const char* rt = (const char*)std::memchr( pos, '<', end-pos);
+			if (!rt || end - rt < pagetaglen) return end;
+			if (0==std::memcmp( rt, pagetag, pagetaglen)) return rt;
+			pos = rt+1;
+		}
+	}
+
+private:
+	void run()
+	{
+		if (g_verbosity >= 1) std::cerr << strus::string_format( "scanner %d started\n", m_shardIndex) << std::flush;
+		try
+		{
+			if (g_fastScan)
+			{
+				m_scanner.runFast( m_begin, m_end, 0/*inputOffset*/);
+			}
+			else
+			{
+				m_scanner.run( strus::MemoryInputIterator( m_begin, m_end), 0/*inputOffset*/);
+			}
+		}
+		catch (const std::bad_alloc&)
+		{
+			m_error = strus::string_format( "out of memory in scanner %d", m_shardIndex);
+		}
+		catch (const std::runtime_error& err)
+		{
+			m_error = strus::string_format( "error in scanner %d: %s", m_shardIndex, err.what());
+		}
+		if (g_verbosity >= 1) std::cerr << strus::string_format( "scanner %d terminated\n", m_shardIndex) << std::flush;
+	}
 
+private:
+	DumpScanner m_scanner;
+	int m_shardIndex;
+	const char* m_begin;
+	const char* m_end;
+	strus::thread* m_thread;
+	std::string m_error;
+};
 
 int main( int argc, const char* argv[])
 {
@@ -772,15 +1884,9 @@ int main( int argc, const char* argv[])
 	{
 		int argi = 1;
 		int nofThreads = 0;
-		int counterMod = 0;
-		std::set<int> namespacemap;
-		bool namespaceset = false;
 		bool printusage = false;
-		bool collectRedirects = false;
 		bool loadRedirects = false;
 		std::string linkmapfilename;
-		std::string dumpfilename;
-		std::vector<std::string> selectDocumentPattern;
 
 		for (;argi < argc; ++argi)
 		{
@@ -802,10 +1908,10 @@ int main( int argc, const char* argv[])
 			}
 			else if (0==std::strcmp(argv[argi],"-K"))
 			{
-				if (!dumpfilename.empty()) throw std::runtime_error("duplicated option -K <filename>");
+				if (!g_dumpfilename.empty()) throw std::runtime_error("duplicated option -K <filename>");
 				++argi;
 				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option -K without argument");
-				dumpfilename = argv[ argi];
+				g_dumpfilename = argv[ argi];
 			}
 			else if (0==std::strcmp(argv[argi],"-I"))
 			{
@@ -817,16 +1923,16 @@ int main( int argc, const char* argv[])
 			}
 			else if (0==std::memcmp(argv[argi],"-P",2))
 			{
-				if (counterMod > 0) throw std::runtime_error( "duplicated option -P <mod>");
-				counterMod = getUIntOptionArg( argi, argc, argv);
-				if (!counterMod) throw std::runtime_error( "option -P requires positive integer as argument");
+				if (g_counterMod > 0) throw std::runtime_error( "duplicated option -P <mod>");
+				g_counterMod = getUIntOptionArg( argi, argc, argv);
+				if (!g_counterMod) throw std::runtime_error( "option -P requires positive integer as argument");
 				++argi;
 			}
 			else if (0==std::memcmp(argv[argi],"-S",2))
 			{
 				++argi;
 				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option -S without argument");
-				selectDocumentPattern.push_back( argv[ argi]);
+				g_selectDocumentPattern.push_back( argv[ argi]);
 			}
 			else if (0==std::memcmp(argv[argi],"-L",2))
 			{
@@ -842,12 +1948,11 @@ int main( int argc, const char* argv[])
 				++argi;
 				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option -R without argument");
 				linkmapfilename = argv[ argi];
-				collectRedirects = true;
+				g_collectRedirects = true;
 			}
 			else if (0==std::memcmp(argv[argi],"-n",2))
 			{
-				namespaceset = true;
-				namespacemap.insert( getUIntOptionArg( argi, argc, argv));
+				g_namespacemap.insert( getUIntOptionArg( argi, argc, argv));
 				++argi;
 			}
 			else if (0==std::memcmp(argv[argi],"-t",2))
@@ -855,6 +1960,184 @@ int main( int argc, const char* argv[])
 				nofThreads = getUIntOptionArg( argi, argc, argv);
 				++argi;
 			}
+			else if (0==std::strcmp(argv[argi],"--mmap"))
+			{
+				g_useMemoryMap = true;
+			}
+			else if (0==std::strcmp(argv[argi],"--checkpoint"))
+			{
+				if (!g_checkpointFile.empty()) throw std::runtime_error( "duplicated option --checkpoint <file>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --checkpoint without argument");
+				g_checkpointFile = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--manifest"))
+			{
+				if (!g_manifestFile.empty()) throw std::runtime_error( "duplicated option --manifest <file>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --manifest without argument");
+				g_manifestFile = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--incremental"))
+			{
+				if (!g_previousManifestFile.empty()) throw std::runtime_error( "duplicated option --incremental <file>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --incremental without argument");
+				g_previousManifestFile = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--tgz"))
+			{
+				if (g_archiveSize > 0) throw std::runtime_error( "duplicated option --tgz <mb>");
+				g_archiveSize = getUIntOptionArg( argi, argc, argv);
+				if (!g_archiveSize) throw std::runtime_error( "option --tgz requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--checkpointinterval"))
+			{
+				if (g_checkpointInterval > 0) throw std::runtime_error( "duplicated option --checkpointinterval <n>");
+				g_checkpointInterval = getUIntOptionArg( argi, argc, argv);
+				if (!g_checkpointInterval) throw std::runtime_error( "option --checkpointinterval requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--resume"))
+			{
+				g_resume = true;
+			}
+			else if (0==std::strcmp(argv[argi],"--readahead"))
+			{
+				if (g_readAheadDepth > 0) throw std::runtime_error( "duplicated option --readahead <n>");
+				g_readAheadDepth = getUIntOptionArg( argi, argc, argv);
+				if (!g_readAheadDepth) throw std::runtime_error( "option --readahead requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--readaheadsize"))
+			{
+				if (g_readAheadSize > 0) throw std::runtime_error( "duplicated option --readaheadsize <kb>");
+				g_readAheadSize = getUIntOptionArg( argi, argc, argv);
+				if (!g_readAheadSize || g_readAheadSize > (1<<20)) throw std::runtime_error( "option --readaheadsize requires an integer between 1 and 1048576 as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--fastscan"))
+			{
+				g_fastScan = true;
+			}
+			else if (0==std::strcmp(argv[argi],"--shards"))
+			{
+				if (g_nofShards > 0) throw std::runtime_error( "duplicated option --shards <n>");
+				g_nofShards = getUIntOptionArg( argi, argc, argv);
+				if (!g_nofShards) throw std::runtime_error( "option --shards requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--queuedocs"))
+			{
+				if (g_maxQueuedDocs >= 0) throw std::runtime_error( "duplicated option --queuedocs <n>");
+				g_maxQueuedDocs = getUIntOptionArg( argi, argc, argv);
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--queuemb"))
+			{
+				if (g_maxQueuedMB >= 0) throw std::runtime_error( "duplicated option --queuemb <mb>");
+				g_maxQueuedMB = getUIntOptionArg( argi, argc, argv);
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--batchdocs"))
+			{
+				if (g_batchDocs > 0) throw std::runtime_error( "duplicated option --batchdocs <n>");
+				g_batchDocs = getUIntOptionArg( argi, argc, argv);
+				if (!g_batchDocs) throw std::runtime_error( "option --batchdocs requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--batchkb"))
+			{
+				if (g_batchKB > 0) throw std::runtime_error( "duplicated option --batchkb <kb>");
+				g_batchKB = getUIntOptionArg( argi, argc, argv);
+				if (!g_batchKB) throw std::runtime_error( "option --batchkb requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--iothreads"))
+			{
+				if (g_nofIoThreads > 0) throw std::runtime_error( "duplicated option --iothreads <n>");
+				g_nofIoThreads = getUIntOptionArg( argi, argc, argv);
+				if (!g_nofIoThreads) throw std::runtime_error( "option --iothreads requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--affinity"))
+			{
+				++argi;
+				if (argi == argc || argv[argi][0] == '-') throw std::runtime_error( "option --affinity without argument");
+				if (!g_cpuAffinity.empty()) throw std::runtime_error( "duplicated option --affinity <cpus>");
+				g_cpuAffinity = strus::parseCpuList( argv[argi]);
+			}
+			else if (0==std::strcmp(argv[argi],"--stats"))
+			{
+				++argi;
+				if (argi == argc || argv[argi][0] == '-') throw std::runtime_error( "option --stats without argument");
+				if (!g_statisticsFile.empty()) throw std::runtime_error( "duplicated option --stats <file>");
+				g_statisticsFile = argv[argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--statsinterval"))
+			{
+				if (g_statisticsInterval > 0) throw std::runtime_error( "duplicated option --statsinterval <sec>");
+				g_statisticsInterval = getUIntOptionArg( argi, argc, argv);
+				if (!g_statisticsInterval) throw std::runtime_error( "option --statsinterval requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--cpulimit"))
+			{
+				if (g_docCpuLimitMs > 0) throw std::runtime_error( "duplicated option --cpulimit <ms>");
+				g_docCpuLimitMs = getUIntOptionArg( argi, argc, argv);
+				if (!g_docCpuLimitMs) throw std::runtime_error( "option --cpulimit requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--window"))
+			{
+				if (g_scheduleWindow > 0) throw std::runtime_error( "duplicated option --window <n>");
+				g_scheduleWindow = getUIntOptionArg( argi, argc, argv);
+				if (!g_scheduleWindow) throw std::runtime_error( "option --window requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--numbering"))
+			{
+				++argi;
+				if (argi == argc || argv[argi][0] == '-') throw std::runtime_error( "option --numbering without argument");
+				if (0==std::strcmp( argv[argi], "order"))
+				{
+					g_docNumbering = NumberByOrder;
+				}
+				else if (0==std::strcmp( argv[argi], "pageid"))
+				{
+					g_docNumbering = NumberByPageId;
+				}
+				else if (0==std::strcmp( argv[argi], "titlehash"))
+				{
+					g_docNumbering = NumberByTitleHash;
+				}
+				else
+				{
+					throw std::runtime_error( strus::string_format( "unknown argument '%s' of option --numbering, expected 'order', 'pageid' or 'titlehash'", argv[argi]));
+				}
+			}
+			else if (0==std::strcmp(argv[argi],"--bz2"))
+			{
+				if (g_bzip2Threads > 0) throw std::runtime_error( "duplicated option --bz2 <threads>");
+				g_bzip2Threads = getUIntOptionArg( argi, argc, argv);
+				if (!g_bzip2Threads) throw std::runtime_error( "option --bz2 requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--bz2segment"))
+			{
+				if (g_bzip2SegmentKB > 0) throw std::runtime_error( "duplicated option --bz2segment <kb>");
+				g_bzip2SegmentKB = getUIntOptionArg( argi, argc, argv);
+				if (!g_bzip2SegmentKB) throw std::runtime_error( "option --bz2segment requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--bz2index"))
+			{
+				if (!g_bzip2IndexFile.empty()) throw std::runtime_error( "duplicated option --bz2index <indexfile>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --bz2index without argument");
+				g_bzip2IndexFile = argv[ argi];
+			}
 			else if (0==std::strcmp(argv[argi],"--stdout"))
 			{
 				g_dumpStdout = true;
@@ -913,9 +2196,93 @@ int main( int argc, const char* argv[])
 			std::cerr << "                  but you should use this format if you process the XML with strus." << std::endl;
 			std::cerr << "    -R <lnkfile> :Collect redirects only and write them to <lnkfile>" << std::endl;
 			std::cerr << "    -L <lnkfile> :Load link file <lnkfile> for verifying page links" << std::endl;
+			std::cerr << "    --mmap       :Map the input file into memory instead of reading it" << std::endl;
+			std::cerr << "                  (not possible for stdin)" << std::endl;
+			std::cerr << "    --tgz <mb>   :Write the output files into gzip compressed tar archives" << std::endl;
+			std::cerr << "                  <slot>_<seqno>.tar.gz in the output directory instead of" << std::endl;
+			std::cerr << "                  single files, one archive written per conversion thread." << std::endl;
+			std::cerr << "                  An archive is closed when its size exceeds <mb> MB (uncompressed)." << std::endl;
+			std::cerr << "                  Archives not completed yet have the extension .tmp" << std::endl;
+			std::cerr << "    --manifest <file>:Write the list of documents converted with the id and sha1" << std::endl;
+			std::cerr << "                  of their revision and their output file to <file>" << std::endl;
+			std::cerr << "    --incremental <file>:Convert only documents that are new or changed compared" << std::endl;
+			std::cerr << "                  with the manifest <file> of a previous run (option --manifest)." << std::endl;
+			std::cerr << "                  The new manifest marks documents as new, changed, unchanged" << std::endl;
+			std::cerr << "                  or deleted. Unchanged documents referring to pages changed" << std::endl;
+			std::cerr << "                  (e.g. redirects of option -L) are not converted again" << std::endl;
+			std::cerr << "    --checkpoint <file>:Write checkpoints of the conversion to <file> for" << std::endl;
+			std::cerr << "                  resuming it after an interruption (option --resume)" << std::endl;
+			std::cerr << "    --checkpointinterval <n>:Write a checkpoint every <n> documents (default 1000)" << std::endl;
+			std::cerr << "    --resume     :Resume an interrupted conversion from the checkpoint file" << std::endl;
+			std::cerr << "                  of option --checkpoint, skipping documents already written" << std::endl;
+			std::cerr << "    --readahead <n>:Read the input with a dedicated thread into a ring of <n>" << std::endl;
+			std::cerr << "                  buffers, so that the scanner does not wait for I/O as long" << std::endl;
+			std::cerr << "                  as a buffer is filled. The time the scanner was blocked" << std::endl;
+			std::cerr << "                  waiting for input is reported at the end." << std::endl;
+			std::cerr << "    --readaheadsize <kb>:Size of the buffers of option --readahead in KB" << std::endl;
+			std::cerr << "                  (default 4096)" << std::endl;
+			std::cerr << "    --fastscan   :Extract the pages with a fast scanner specialized on the dump" << std::endl;
+			std::cerr << "                  structure, using the generic XML scanner only for pages" << std::endl;
+			std::cerr << "                  it can not handle (implies --mmap, not for stdin)" << std::endl;
+			std::cerr << "    --shards <n> :Split the input file into <n> parts scanned in parallel" << std::endl;
+			std::cerr << "                  by <n> scanner threads, each feeding its own subset of the" << std::endl;
+			std::cerr << "                  conversion threads (input is memory mapped, not for stdin)." << std::endl;
+			std::cerr << "                  Document k of part i gets the number k*<n>+i, so the output" << std::endl;
+			std::cerr << "                  directories (number/1000) and the suffixes of names of documents" << std::endl;
+			std::cerr << "                  with long titles differ from a run without --shards (but not" << std::endl;
+			std::cerr << "                  between runs with the same <n>)." << std::endl;
+			std::cerr << "    --queuedocs <n>:Maximum number of documents queued for the conversion threads" << std::endl;
+			std::cerr << "                  (default 0 = no limit)" << std::endl;
+			std::cerr << "    --queuemb <mb>:Maximum size of documents queued for the conversion threads" << std::endl;
+			std::cerr << "                  in MB (default 0 = no limit)." << std::endl;
+			std::cerr << "                  If the queues are full, the scanner converts the document itself." << std::endl;
+			std::cerr << "                  The batch of documents collected by the scanner (option --batchkb)" << std::endl;
+			std::cerr << "                  is not counted. Output not written yet (option --iothreads) is" << std::endl;
+			std::cerr << "                  limited separately to " << (int)MaxPendingOutputMB << " MB" << std::endl;
+			std::cerr << "    --batchdocs <n>:Pass the documents to the conversion threads in batches of" << std::endl;
+			std::cerr << "                  at most <n> documents (default " << (int)DefaultBatchDocs << ", 1 = no batching)" << std::endl;
+			std::cerr << "    --batchkb <kb>:Pass a batch to the conversion threads when its documents" << std::endl;
+			std::cerr << "                  reach a size of <kb> KB (default " << (int)DefaultBatchKB << ", used with --batchdocs > 1)" << std::endl;
+			std::cerr << "    --iothreads <n>:Write the output files with <n> dedicated threads instead of" << std::endl;
+			std::cerr << "                  the conversion threads. The stage 'write' of option --stats" << std::endl;
+			std::cerr << "                  then measures only the time for passing the files to them" << std::endl;
+			std::cerr << "    --window <n> :Collect <n> documents and pass them to the conversion threads" << std::endl;
+			std::cerr << "                  ordered by size, largest first, to avoid that big documents" << std::endl;
+			std::cerr << "                  dispatched late keep a thread busy at the end. The documents" << std::endl;
+			std::cerr << "                  collected count as queued (option --queuemb), the window is" << std::endl;
+			std::cerr << "                  also passed when reaching this limit" << std::endl;
+			std::cerr << "    --cpulimit <ms>:Abort the conversion of a document exceeding <ms> milliseconds" << std::endl;
+			std::cerr << "                  of CPU time, writing the error to its .ftl file. The documents" << std::endl;
+			std::cerr << "                  aborted are listed at the end" << std::endl;
+			std::cerr << "    --stats <file>:Write the time spent and the amounts processed per thread in the" << std::endl;
+			std::cerr << "                  stages of the conversion (scan, lex, build, finish, toxml, report," << std::endl;
+			std::cerr << "                  write), 'report' is building the .wtf, .err and .mis files" << std::endl;
+			std::cerr << "                  as JSON to <file> at the end. Print also the tail latency of the" << std::endl;
+			std::cerr << "                  conversion threads to stderr (as with option -V)" << std::endl;
+			std::cerr << "    --statsinterval <sec>:Write the report of option --stats also every <sec> seconds" << std::endl;
+			std::cerr << "    --affinity <cpus>:Bind the threads to the CPUs of the list <cpus> (e.g. 0-3,8)" << std::endl;
+			std::cerr << "                  in order, first the scanner threads, then the conversion threads," << std::endl;
+			std::cerr << "                  starting again from the beginning if the list is exhausted" << std::endl;
+			std::cerr << "    --numbering <mode>:Numbering of the documents determining the output directory" << std::endl;
+			std::cerr << "                  (number/1000) and the suffix of names of documents with long titles:" << std::endl;
+			std::cerr << "                  'order' = order of the documents in the dump (default)," << std::endl;
+			std::cerr << "                  'pageid' = id of the page in the dump," << std::endl;
+			std::cerr << "                  'titlehash' = hash of the title modulo 10000000, the numbers" << std::endl;
+			std::cerr << "                  are not unique, names of documents with long titles get the" << std::endl;
+			std::cerr << "                  full hash as suffix instead. Pages without page id are skipped" << std::endl;
+			std::cerr << "                  with 'pageid'." << std::endl;
+			std::cerr << "                  'pageid' and 'titlehash' do not depend on the part of the dump" << std::endl;
+			std::cerr << "                  converted, outputs of disjoint parts can be merged." << std::endl;
+			std::cerr << "    --bz2 <threads>:Input file is bzip2 compressed, decompress it with <threads>" << std::endl;
+			std::cerr << "                  threads (not possible for stdin). Parallel decompression needs" << std::endl;
+			std::cerr << "                  a multistream dump (pages-articles-multistream.xml.bz2)" << std::endl;
+			std::cerr << "    --bz2index <idx>:Use the multistream index file <idx> (plain or .bz2)" << std::endl;
+			std::cerr << "                  to locate the streams instead of searching them" << std::endl;
+			std::cerr << "    --bz2segment <kb>:Minimum compressed size in KB of a group of streams" << std::endl;
+			std::cerr << "                  decompressed by one thread of option --bz2 (default " << (int)(strus::Bzip2MultistreamInput::DefaultMinSegmentSize / 1024) << ")" << std::endl;
 			std::cerr << "    --stdout     :Write all output to stdout" << std::endl;
-			std::cerr << "    --test <EXP> :Write all output to a string and compare it with the content" << std::endl;
-			std::cerr << "                  of the file <EXP> (single threaded only)" << std::endl;
+			std::cerr << "    --test <EXP> :Compare all output in the order of the documents with the content" << std::endl;
+			std::cerr << "                  of the file <EXP> (single threaded with option --numbering)" << std::endl;
 			std::cerr << std::endl;
 			std::cerr << "Description:" << std::endl;
 			std::cerr << "  Takes a unpacked Wikipedia XML dump as input and tries to convert it to\n";
@@ -972,41 +2339,183 @@ int main( int argc, const char* argv[])
 			std::cerr << std::endl;
 			return rt;
 		}
-		IStream input( argv[argi]);
+		std::string inputpath( argv[argi]);
 		if (argi+1 < argc)
 		{
-			if (collectRedirects) std::cerr << "output directory ignored if option -R is specified" << std::endl;
+			if (g_collectRedirects) std::cerr << "output directory ignored if option -R is specified" << std::endl;
 			g_outputdir = argv[argi+1];
 		}
-		if (g_doTest)
+		if (g_doTest && g_docNumbering != NumberByOrder)
 		{
-			if (nofThreads != 0) std::cerr << "number of threads (option -t) ignored if option --test is specified" << std::endl;
+			//... test outputs are compared in the order of the document numbers, that is only the order of the dump when numbered by order
+			if (nofThreads != 0) std::cerr << "number of threads (option -t) ignored if option --test is specified with option --numbering" << std::endl;
 			nofThreads = 0;
 		}
-		if (collectRedirects)
+		if (g_collectRedirects)
 		{
 			if (nofThreads != 0) std::cerr << "number of threads (option -t) ignored if option -R is specified" << std::endl;
 			if (g_beautified) std::cerr << "beautyfication (option -B) ignored if option -R is specified" << std::endl;
 			if (g_dumps) std::cerr << "write dumps allways (option -D) ignored if option -R is specified" << std::endl;
 			if (loadRedirects) std::cerr << "option -L not compatiple with option -R" << std::endl;
 		}
-		textwolf::IStreamIterator inputiterator( &input, 1<<16/*buffer size*/);
+		if ((!g_bzip2IndexFile.empty() || g_bzip2SegmentKB) && !g_bzip2Threads)
+		{
+			throw std::runtime_error( "options --bz2index and --bz2segment require option --bz2 <threads>");
+		}
+		if (g_nofShards)
+		{
+			if (g_doTest || g_collectRedirects)
+			{
+				std::cerr << "option --shards ignored if option --test or -R is specified" << std::endl;
+				g_nofShards = 0;
+			}
+			else if (g_bzip2Threads)
+			{
+				throw std::runtime_error( "option --shards not compatible with option --bz2");
+			}
+		}
+		if (g_fastScan)
+		{
+			if (g_bzip2Threads) throw std::runtime_error( "option --fastscan not compatible with option --bz2");
+			if (g_verbosity >= 2)
+			{
+				std::cerr << "option --fastscan ignored with verbosity level 2 (option -VV)" << std::endl;
+				g_fastScan = false;
+			}
+			else
+			{
+				g_useMemoryMap = true;
+			}
+		}
+		if (g_bzip2Threads && g_useMemoryMap)
+		{
+			std::cerr << "option --mmap ignored if option --bz2 is specified (compressed input is always mapped)" << std::endl;
+			g_useMemoryMap = false;
+		}
+		if (!g_batchDocs) g_batchDocs = DefaultBatchDocs;
+		if (!g_batchKB) g_batchKB = DefaultBatchKB;
+		std::vector<int>::const_iterator ci = g_cpuAffinity.begin(), ce = g_cpuAffinity.end();
+		for (; ci != ce; ++ci)
+		{
+			if (!strus::isCpuAvailable( *ci)) throw std::runtime_error( strus::string_format( "CPU %d of option --affinity not available", *ci));
+		}
+		if ((g_resume || g_checkpointInterval) && g_checkpointFile.empty())
+		{
+			throw std::runtime_error( "options --resume and --checkpointinterval require option --checkpoint <file>");
+		}
+		if (!g_checkpointFile.empty())
+		{
+			if (g_nofShards) throw std::runtime_error( "option --checkpoint not compatible with option --shards");
+			if (g_collectRedirects) throw std::runtime_error( "option --checkpoint not compatible with option -R");
+			if (g_doTest) throw std::runtime_error( "option --checkpoint not compatible with option --test");
+			if (g_docNumbering != NumberByOrder) throw std::runtime_error( "option --checkpoint requires document numbering by order (option --numbering)");
+		}
+		if (g_archiveSize)
+		{
+			if (g_collectRedirects) throw std::runtime_error( "option --tgz not compatible with option -R");
+			if (g_doTest) throw std::runtime_error( "option --tgz not compatible with option --test");
+			if (g_dumpStdout) throw std::runtime_error( "option --tgz not compatible with option --stdout");
+			if (!g_checkpointFile.empty()) throw std::runtime_error( "option --tgz not compatible with option --checkpoint");
+		}
+		if (!g_previousManifestFile.empty() && g_manifestFile.empty())
+		{
+			throw std::runtime_error( "option --incremental requires option --manifest <file>");
+		}
+		if (!g_manifestFile.empty())
+		{
+			if (g_nofShards) throw std::runtime_error( "option --manifest not compatible with option --shards");
+			if (g_collectRedirects) throw std::runtime_error( "option --manifest not compatible with option -R");
+			if (g_doTest) throw std::runtime_error( "option --manifest not compatible with option --test");
+			if (!g_checkpointFile.empty()) throw std::runtime_error( "option --manifest not compatible with option --checkpoint");
+		}
+		if (g_readAheadSize && !g_readAheadDepth)
+		{
+			throw std::runtime_error( "option --readaheadsize <kb> requires option --readahead <n>");
+		}
+		if (g_readAheadDepth && (g_useMemoryMap || g_nofShards || g_bzip2Threads))
+		{
+			std::cerr << "option --readahead ignored for memory mapped or bzip2 input" << std::endl;
+			g_readAheadDepth = 0;
+		}
+		if (!g_readAheadSize) g_readAheadSize = 4096;
 		if (nofThreads <= 0) nofThreads = 0;
 		g_errorhnd = strus::createErrorBuffer_standard( NULL/*logfilehandle*/, nofThreads+2, NULL/*debugTrace*/);
 		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer");
 
+		strus::PageFilter pageFilter( g_namespacemap, g_selectDocumentPattern);
+		if (!g_namespacemap.empty() || !g_selectDocumentPattern.empty())
+		{
+			g_pageFilter = &pageFilter;
+		}
+		strus::local_ptr<strus::Checkpoint> checkpoint;
+		if (!g_checkpointFile.empty())
+		{
+			checkpoint.reset( new strus::Checkpoint( g_checkpointFile, g_checkpointInterval ? g_checkpointInterval : 1000));
+			if (g_resume)
+			{
+				if (checkpoint->load())
+				{
+					std::cerr << strus::string_format( "resuming conversion at document %d (input offset %lu)\n", checkpoint->startDocno(), (unsigned long)checkpoint->startOffset()) << std::flush;
+				}
+				else
+				{
+					std::cerr << "no checkpoint file found, starting conversion from the beginning" << std::endl;
+				}
+			}
+			g_checkpoint = checkpoint.get();
+		}
+		if (g_statisticsInterval && g_statisticsFile.empty())
+		{
+			throw std::runtime_error( "option --statsinterval requires option --stats <file>");
+		}
+		strus::local_ptr<strus::StageStatistics> statistics;
+		if (!g_statisticsFile.empty())
+		{
+			statistics.reset( new strus::StageStatistics( nofScannerThreads(), nofThreads, g_statisticsFile, g_statisticsInterval));
+			g_statistics = statistics.get();
+		}
+		strus::local_ptr<strus::TestOutput> testOutput;
+		if (g_doTest)
+		{
+			testOutput.reset( new strus::TestOutput( g_testExpectedFilename));
+			g_testOutput = testOutput.get();
+		}
+		strus::local_ptr<strus::OutputWriter> outputWriter;
+		if (g_nofIoThreads && !g_archiveSize && !g_dumpStdout && !g_doTest && !g_collectRedirects)
+		{
+			outputWriter.reset( new strus::OutputWriter( g_nofIoThreads, (std::size_t)MaxPendingOutputMB * 1024 * 1024, g_checkpoint));
+			g_outputWriter = outputWriter.get();
+		}
+		strus::local_ptr<strus::OutputArchives> outputArchives;
+		if (g_archiveSize)
+		{
+			outputArchives.reset( new strus::OutputArchives( g_outputdir, nofThreads, (std::size_t)g_archiveSize * 1024 * 1024));
+			g_outputArchives = outputArchives.get();
+		}
+		strus::local_ptr<strus::Manifest> manifest;
+		if (!g_manifestFile.empty())
+		{
+			manifest.reset( new strus::Manifest());
+			if (!g_previousManifestFile.empty())
+			{
+				manifest->loadPrevious( g_previousManifestFile);
+			}
+			g_manifest = manifest.get();
+		}
 		strus::local_ptr<strus::LinkMap> linkmap;
 		strus::LinkMapBuilder linkmapBuilder( g_errorhnd);
 		if (!linkmapfilename.empty())
 		{
 			linkmap.reset( new strus::LinkMap( g_errorhnd));
-			if (!collectRedirects)
+			if (!g_collectRedirects)
 			{
 				linkmap->load( linkmapfilename);
 				g_linkmap = linkmap.get();
 			}
 		}
 
+		WorkerGroup workerGroup;
+		//... declared before the workers, as they refer to it until they are destroyed
 		struct WorkerArray
 		{
 			WorkerArray( Worker* ar_)
@@ -1018,247 +2527,157 @@ int main( int argc, const char* argv[])
 			Worker* ar;
 		};
 		WorkerArray workers( nofThreads ? new Worker[ nofThreads] : 0);
+		workerGroup.init( workers.ar, nofThreads, g_maxQueuedDocs > 0 ? g_maxQueuedDocs : 0, g_maxQueuedMB > 0 ? (std::size_t)g_maxQueuedMB * 1024 * 1024 : 0);
+		if (!g_cpuAffinity.empty()) printThreadPlacement( nofThreads);
 		for (int wi=0; wi < nofThreads; ++wi)
 		{
-			workers.ar[ wi].start( wi+1);
+			workers.ar[ wi].start( wi+1, &workerGroup);
 		}
 
-		bool terminated = false;
-		struct DocAttributes
+		DumpScanner scanner( workers.ar, nofThreads, &linkmapBuilder, 0/*shardIndex*/, 1/*nofShards*/);
+		textwolf::PositionIndex inputOffset = g_checkpoint ? g_checkpoint->startOffset() : 0;
+		if (g_nofShards)
 		{
-			int ns;
-			std::string title;
-			std::string redirect_title;
-			std::string content;
-
-			DocAttributes()
-				:ns(0),title(),redirect_title(){}
-			void clear()
+			strus::MappedFile input( inputpath);
+			std::vector<ShardScanner*> shards;
+			try
 			{
-				ns = 0;
-				title.clear();
-				redirect_title.clear();
-				content.clear();
-			}
-		};
-
-		XmlScanner xs( inputiterator);
-		XmlScanner::iterator itr=xs.begin(),end=xs.end();
-		DocAttributes docAttributes;
-		int workeridx = 0;
-		int docCounter = 0;
-		TagId lastTag = TagIgnored;
-		std::vector<TagId> tagstack;
-
-		for (; !terminated && itr!=end; ++itr)
-		{
-			if (g_verbosity >= 2) std::cout << "XML " << itr->name() << " " << strus::outputLineString( itr->content(), itr->content()+itr->size(), 80) << std::endl;
-			switch (itr->type())
-			{
-				case XmlScanner::None: break;
-				case XmlScanner::ErrorOccurred: throw std::runtime_error( itr->content());
-				case XmlScanner::HeaderStart:/*no break!*/
-				case XmlScanner::HeaderAttribName:/*no break!*/
-				case XmlScanner::HeaderAttribValue:/*no break!*/
-				case XmlScanner::HeaderEnd:/*no break!*/
-				case XmlScanner::DocAttribValue:/*no break!*/
-				case XmlScanner::DocAttribEnd:/*no break!*/
-					break;
-				case XmlScanner::TagAttribName:
-				{
-					if (lastTag == TagRedirect)
-					{
-						if (itr->size() == 5 && 0==std::memcmp( itr->content(), "title", itr->size()))
-						{
-							++itr;
-							if (itr->type() == XmlScanner::TagAttribValue)
-							{
-								docAttributes.redirect_title = std::string( itr->content(), itr->size());
-							}
-						}
-					}
-					break;
-				}
-				case XmlScanner::TagAttribValue:
-				{
-					break;
-				}
-				case XmlScanner::OpenTag: 
+				const char* shardstart = input.begin();
+				for (int si=0; si < g_nofShards; ++si)
 				{
-					lastTag = TagIgnored;
-					if (namespaceset && itr->size() == 2  && 0==std::memcmp( itr->content(), "ns", itr->size()))
-					{
-						lastTag = TagNs;
-					}
-					else if (itr->size() == 4 && 0==std::memcmp( itr->content(), "page", itr->size()))
-					{
-						lastTag = TagPage;
-						docAttributes.clear();
-						if (docCounter % 1000 == 0 && !collectRedirects && !g_dumpStdout && !g_doTest)
-						{
-							createOutputDir( docCounter);
-						}
-					}
-					else if (itr->size() == 5 && 0==std::memcmp( itr->content(), "title", itr->size()))
-					{
-						lastTag = TagTitle;
-					}
-					if (itr->size() == 4 && 0==std::memcmp( itr->content(), "text", itr->size()))
-					{
-						lastTag = TagText;
-					}
-					if (itr->size() == 8 && 0==std::memcmp( itr->content(), "redirect", itr->size()))
-					{
-						lastTag = TagRedirect;
-					}
-					tagstack.push_back( lastTag);
-					break;
+					const char* shardend = (si+1 == g_nofShards)
+						? input.end()
+						: ShardScanner::alignToPage( std::max( shardstart, input.begin() + (input.size() / g_nofShards) * (si+1)), input.end());
+					int workerstart = (nofThreads * si) / g_nofShards;
+					int workerend = (nofThreads * (si+1)) / g_nofShards;
+					shards.push_back( new ShardScanner( workers.ar + workerstart, workerend - workerstart, si, g_nofShards, shardstart, shardend));
+					shardstart = shardend;
 				}
-				case XmlScanner::CloseTagIm:
-				case XmlScanner::CloseTag:
+				std::vector<ShardScanner*>::iterator hi = shards.begin(), he = shards.end();
+				for (; hi != he; ++hi) (*hi)->start();
+				std::string errors;
+				for (hi = shards.begin(); hi != he; ++hi)
 				{
-					lastTag = TagIgnored;
-					TagId closedTag = TagIgnored;
-					if (!tagstack.empty())
-					{
-						closedTag = tagstack.back();
-						tagstack.pop_back();
-					}
-					if (closedTag == TagPage)
+					(*hi)->waitTermination();
+					if (!(*hi)->error().empty())
 					{
-						if (namespaceset && namespacemap.find( docAttributes.ns) == namespacemap.end())
-						{
-							//... ignore document but those with ns set to what is selected by option '-n'
-							continue;
-						}
-						if (!selectDocumentPattern.empty())
-						{
-							std::vector<std::string>::const_iterator si = selectDocumentPattern.begin(), se = selectDocumentPattern.end();
-							for (; si != se && 0==std::strstr( docAttributes.title.c_str(), si->c_str()); ++si){}
-							if (si == se) continue;
-						}
-						if (!docAttributes.redirect_title.empty() && docAttributes.content.size() < 1000)
-						{
-							// ... is as Redirect
-							if (collectRedirects)
-							{
-								++docCounter;
-								std::pair<std::string,std::string> redir_parts = strus::LinkMap::getLinkParts( docAttributes.redirect_title);
-								if (g_verbosity >= 1) std::cerr << strus::string_format( "%s => %s\n", docAttributes.title.c_str(), docAttributes.redirect_title.c_str());
-								linkmapBuilder.redirect( docAttributes.title, redir_parts.first);
-
-								if (counterMod && g_verbosity == 0 && docCounter % counterMod == 0)
-								{
-									std::cerr << "processed " << docCounter << " documents" << std::endl;
-								}
-							}
-						}
-						else if (!docAttributes.title.empty() && !docAttributes.content.empty())
-						{
-							// ... is as Document
-							if (collectRedirects)
-							{
-								++docCounter;
-								if (g_verbosity >= 1) std::cerr << strus::string_format( "link %s => %s\n", docAttributes.title.c_str(), docAttributes.title.c_str());
-								linkmapBuilder.define( docAttributes.title);
-
-								if (counterMod && g_verbosity == 0 && docCounter % counterMod == 0)
-								{
-									std::cerr << "processed " << docCounter << " documents" << std::endl;
-								}
-							}
-							else
-							{
-								if (!dumpfilename.empty())
-								{
-									int ec = strus::writeFile( dumpfilename, docAttributes.content);
-									if (ec) std::cerr << "failed to write dump file " << dumpfilename << ": " << ::strerror(ec) << std::endl;
-								}
-								++docCounter;
-								int docIndex = docCounter-1;
-								if (nofThreads)
-								{
-									workeridx = docIndex % nofThreads;
-									workers.ar[ workeridx].push( docIndex, docAttributes.title, docAttributes.content);
-								}
-								else
-								{
-									try
-									{
-										Work work( docIndex, docAttributes.title, docAttributes.content, g_dumps);
-										if (g_verbosity >= 1) std::cerr << strus::string_format( "process document '%s'\n", docAttributes.title.c_str()) << std::flush;
-										work.process();
-									} 
-									catch (const std::bad_alloc&)
-									{
-										std::cerr << "out of memory processing document " << docAttributes.title << std::endl;
-									}
-									catch (const std::runtime_error& err)
-									{
-										std::cerr << "error processing document " << docAttributes.title << ": " << err.what() << std::endl;
-									}
-								}
-								if (counterMod && g_verbosity == 0 && docCounter % counterMod == 0)
-								{
-									std::cerr << "processed " << docCounter << " documents" << std::endl;
-								}
-							}
-						}
-						else if (docAttributes.content.empty())
-						{
-							std::cerr << "empty document '" << docAttributes.title << "'" << std::endl;
-						}
-						else
-						{
-							std::cerr << "invalid document '" << docAttributes.title << "'" << std::endl;
-						}
+						if (!errors.empty()) errors.append( "; ");
+						errors.append( (*hi)->error());
 					}
-					break;
 				}
-				case XmlScanner::Content:
-					switch (lastTag)
-					{
-						case TagIgnored:
-							break;
-						case TagPage:
-							break;
-						case TagNs:
-						{
-							std::string contentstr( itr->content(), itr->size());
-							docAttributes.ns = strus::numstring_conv::toint( contentstr, 10000);
-							break;
-						}
-						case TagTitle:
-						{
-							docAttributes.title = std::string( itr->content(), itr->size());
-							break;
-						}
-						case TagText:
-						{
-							docAttributes.content = std::string( itr->content(), itr->size());
-							break;
-						}
-						case TagRedirect:
-						{
-							docAttributes.redirect_title = std::string( itr->content(), itr->size());
-							break;
-						}
-					}
-					break;
-				case XmlScanner::Exit:
-					terminated = true;
-					break;
+				for (hi = shards.begin(); hi != he; ++hi) delete *hi;
+				shards.clear();
+				if (!errors.empty()) throw std::runtime_error( errors);
+			}
+			catch (...)
+			{
+				std::vector<ShardScanner*>::iterator hi = shards.begin(), he = shards.end();
+				for (; hi != he; ++hi) delete *hi;
+				throw;
+			}
+		}
+		else if (g_bzip2Threads)
+		{
+			std::size_t minSegmentSize = g_bzip2SegmentKB ? (std::size_t)g_bzip2SegmentKB * 1024 : (std::size_t)strus::Bzip2MultistreamInput::DefaultMinSegmentSize;
+			strus::Bzip2MultistreamInput input( inputpath, g_bzip2IndexFile, g_bzip2Threads, minSegmentSize);
+			skipInput( input, inputOffset);
+			scanner.run( textwolf::IStreamIterator( &input, 1<<16/*buffer size*/), inputOffset);
+		}
+		else if (g_useMemoryMap)
+		{
+			strus::MappedFile input( inputpath);
+			if (inputOffset > input.size()) throw std::runtime_error( "checkpoint offset is beyond the end of the input file");
+			if (g_fastScan)
+			{
+				scanner.runFast( input.begin() + inputOffset, input.end(), inputOffset);
+			}
+			else
+			{
+				scanner.run( strus::MemoryInputIterator( input.begin() + inputOffset, input.end()), inputOffset);
 			}
 		}
+		else if (g_readAheadDepth)
+		{
+			IStream input( inputpath);
+			strus::ReadAheadInput readAheadInput( &input, (std::size_t)g_readAheadSize * 1024, g_readAheadDepth);
+			skipInput( readAheadInput, inputOffset);
+			scanner.run( textwolf::IStreamIterator( &readAheadInput, 1<<16/*buffer size*/), inputOffset);
+			std::cerr << strus::string_format(
+					"scanner blocked %.3f seconds waiting for input in %d of %d buffers read ahead (%d x %d KB)\n",
+					readAheadInput.blockedTime(), readAheadInput.nofBlockedReads(), readAheadInput.nofBuffersRead(),
+					g_readAheadDepth, g_readAheadSize) << std::flush;
+		}
+		else
+		{
+			IStream input( inputpath);
+			skipInput( input, inputOffset);
+			scanner.run( textwolf::IStreamIterator( &input, 1<<16/*buffer size*/), inputOffset);
+		}
+		double inputEndTime = strus::monotonicTimeSeconds();
+		double lastFinishTime = inputEndTime;
+		int nofStolen = 0;
 		for (int wi=0; wi < nofThreads; ++wi)
 		{
 			workers.ar[ wi].waitTermination();
+			lastFinishTime = std::max( lastFinishTime, workers.ar[ wi].lastFinishTime());
+			nofStolen += workers.ar[ wi].nofStolen();
+		}
+		if (nofThreads && (g_verbosity >= 1 || g_statistics))
+		{
+			std::cerr << strus::string_format( "tail latency %.3f seconds from the end of input to the last document finished, %d documents taken over by idle threads, %d processed by the scanner with queues full\n",
+					lastFinishTime - inputEndTime, nofStolen, workerGroup.nofRejected()) << std::flush;
+		}
+		if (g_statistics)
+		{
+			g_statistics->write();
+		}
+		if (!g_timedOutDocuments.empty())
+		{
+			std::cerr << strus::string_format( "%d documents aborted after exceeding the CPU time limit of %d ms:\n", (int)g_timedOutDocuments.size(), g_docCpuLimitMs);
+			std::vector<std::string>::const_iterator ti = g_timedOutDocuments.begin(), te = g_timedOutDocuments.end();
+			for (; ti != te; ++ti) std::cerr << "\t" << *ti << "\n";
+			std::cerr << std::flush;
+		}
+		if (!g_skippedDocuments.empty())
+		{
+			std::cerr << strus::string_format( "%d documents skipped because of a missing or invalid page id:\n", (int)g_skippedDocuments.size());
+			std::vector<std::string>::const_iterator si = g_skippedDocuments.begin(), se = g_skippedDocuments.end();
+			for (; si != se; ++si) std::cerr << "\t" << *si << "\n";
+			std::cerr << std::flush;
+		}
+		if (g_outputWriter)
+		{
+			g_outputWriter->close();
+			if (g_verbosity >= 1) std::cerr << strus::string_format( "conversion blocked %.3f seconds waiting for output written\n", g_outputWriter->blockedTime()) << std::flush;
+			g_failedOutputFiles.insert( g_failedOutputFiles.end(), g_outputWriter->failedFiles().begin(), g_outputWriter->failedFiles().end());
+		}
+		if (!g_failedOutputFiles.empty())
+		{
+			//... the documents of these files are still marked as completed in the checkpoint, a resumed run does not write them again
+			std::cerr << strus::string_format( "%d output files could not be written or removed:\n", (int)g_failedOutputFiles.size());
+			std::vector<std::string>::const_iterator fi = g_failedOutputFiles.begin(), fe = g_failedOutputFiles.end();
+			for (; fi != fe; ++fi) std::cerr << "\t" << *fi << "\n";
+			std::cerr << std::flush;
+		}
+		if (g_checkpoint)
+		{
+			g_checkpoint->write();
 		}
-		if (collectRedirects && g_verbosity == 0)
+		if (g_outputArchives)
 		{
-			std::cerr << "processed " << docCounter << " documents" << std::endl;
+			g_outputArchives->close();
 		}
-		if (collectRedirects)
+		if (g_manifest)
+		{
+			g_manifest->write( g_manifestFile);
+			std::cerr << strus::string_format( "manifest: %d new, %d changed, %d unchanged, %d deleted documents\n",
+					g_manifest->nofNew(), g_manifest->nofChanged(), g_manifest->nofUnchanged(), g_manifest->nofDeleted()) << std::flush;
+		}
+		if (g_collectRedirects && g_verbosity == 0)
+		{
+			std::cerr << "processed " << scanner.docCounter() << " documents" << std::endl;
+		}
+		if (g_collectRedirects)
 		{
 			std::string unresolved_outfilename = linkmapfilename + ".mis";
 			{
@@ -1279,7 +2698,7 @@ int main( int argc, const char* argv[])
 						out << "## LINKS" << std::endl;
 						linkmap->write( out);
 						out << std::endl;
-						g_testOutput.append( out.str());
+						g_testOutput->writeTrailer( out.str());
 					}
 				}
 				else
@@ -1308,7 +2727,7 @@ int main( int argc, const char* argv[])
 						{
 							std::ostringstream out;
 							out << "## UNRESOLVED" << std::endl << unresolvedstr << std::endl << std::endl;
-							g_testOutput.append( out.str());
+							g_testOutput->writeTrailer( out.str());
 						}
 					}
 					else
@@ -1326,38 +2745,9 @@ int main( int argc, const char* argv[])
 				}
 			}
 		}
-		if (g_doTest)
+		if (g_testOutput)
 		{
-			std::string expected;
-			int ec = strus::readFile( g_testExpectedFilename, expected);
-			if (ec) throw std::runtime_error( strus::string_format( "failed to read expected file '%s' for testing (option --test <expected file>): %s", g_testExpectedFilename.c_str(), ::strerror(ec)));
-			char const* ei = expected.c_str();
-			char const* oi = g_testOutput.c_str();
-			int line = 1;
-			while (*ei && *oi)
-			{
-				if ((*ei == '\r' || *ei == '\n') && (*oi == '\r' || *oi == '\n'))
-				{
-					if (*ei == '\r') ++ei;
-					if (*ei == '\n') ++ei;
-					if (*oi == '\r') ++oi;
-					if (*oi == '\n') ++oi;
-					++line;
-				}
-				else if (*ei != *oi)
-				{
-					break;
-				}
-				else
-				{
-					++ei;
-					++oi;
-				}
-			}
-			if (*ei || *oi)
-			{
-				throw std::runtime_error( strus::string_format( "test outputs differ at line %d", line));
-			}
+			g_testOutput->finish();
 		}
 		if (g_errorhnd) delete g_errorhnd;
 		return rt;
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Case insensitive lookup of tag names with a perfect hash
+/// \file tagNameTable.cpp
+#include "tagNameTable.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <cstring>
+
+using namespace strus;
+
+TagNameTable::TagNameTable()
+	:m_names(),m_sizes(),m_seed(0)
+{
+	std::memset( m_slots, -1, sizeof(m_slots));
+}
+
+bool TagNameTable::fill( unsigned int seed)
+{
+	std::memset( m_slots, -1, sizeof(m_slots));
+	for (std::size_t ni=0; ni < m_names.size(); ++ni)
+	{
+		unsigned char slot = hash( seed, m_names[ ni], m_sizes[ ni]);
+		if (m_slots[ slot] >= 0) return false;
+		m_slots[ slot] = (signed char)ni;
+	}
+	return true;
+}
+
+int TagNameTable::add( const char* name)
+{
+	std::size_t namelen = std::strlen( name);
+	if (namelen == 0 || namelen > MaxNameLength)
+	{
+		throw std::runtime_error( strus::string_format( "invalid size of tag name '%s'", name));
+	}
+	for (std::size_t ii=0; ii<namelen; ++ii)
+	{
+		if (name[ ii] < 'a' || name[ ii] > 'z')
+		{
+			throw std::runtime_error( strus::string_format( "tag name '%s' is not a lowercase identifier", name));
+		}
+	}
+	if (find( name, namelen) >= 0)
+	{
+		throw std::runtime_error( strus::string_format( "duplicate definition of tag name '%s'", name));
+	}
+	if (m_names.size() >= MaxNofNames)
+	{
+		throw std::runtime_error( "too many tag names defined");
+	}
+	m_names.push_back( name);
+	m_sizes.push_back( namelen);
+
+	//... search the first seed without collisions, with a table 4 times the maximum number of names this takes a few thousand attempts at most
+	unsigned int seed = m_seed;
+	while (!fill( seed)) ++seed;
+	m_seed = seed;
+	return m_names.size()-1;
+}
+
+int TagNameTable::findSequential( const char* name, std::size_t namelen) const
+{
+	for (std::size_t ni=0; ni < m_names.size(); ++ni)
+	{
+		const char* ti = m_names[ ni];
+		std::size_t ii = 0;
+		for (; ii<namelen && ti[ ii] && ti[ ii] == (name[ ii]|32); ++ii){}
+		if (ii == namelen && !ti[ ii]) return ni;
+	}
+	return -1;
+}
+
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Case insensitive lookup of tag names with a perfect hash
+/// \file tagNameTable.hpp
+#ifndef _STRUS_WIKIPEDIA_TAG_NAME_TABLE_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_TAG_NAME_TABLE_HPP_INCLUDED
+#include <vector>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Table mapping tag names case insensitive to their index of definition
+/// \remark The seed of the hash function is chosen when a name is added, so that the names defined do not collide.
+///	A lookup computes one hash and compares the name found in the slot, independent of the number of names defined.
+class TagNameTable
+{
+public:
+	enum {
+		NofSlots=256,		///< number of slots of the hash table
+		MaxNameLength=32,	///< maximum length of a name
+		MaxNofNames=64		///< maximum number of names
+	};
+
+	TagNameTable();
+
+	/// \brief Add a name, throws if the name is not a lowercase ASCII identifier or already defined
+	/// \param[in] name name to add (the string is referenced and has to live as long as the table)
+	/// \return index of the name, the number of names added before
+	int add( const char* name);
+
+	/// \brief Find a name
+	/// \param[in] name pointer to the name to find, matching is case insensitive for ASCII letters
+	/// \param[in] namelen length of the name in bytes
+	/// \return index of the name or -1 if not defined
+	int find( const char* name, std::size_t namelen) const
+	{
+		if (namelen == 0 || namelen > MaxNameLength) return -1;
+		int idx = m_slots[ hash( m_seed, name, namelen)];
+		if (idx < 0 || m_sizes[ idx] != namelen) return -1;
+		const char* ni = m_names[ idx];
+		for (std::size_t ii=0; ii<namelen; ++ii)
+		{
+			if (ni[ ii] != (name[ ii]|32)) return -1;
+		}
+		return idx;
+	}
+
+	/// \brief Find a name comparing it with each name defined in the order of definition
+	/// \note Reference implementation for checking and benchmarking find
+	int findSequential( const char* name, std::size_t namelen) const;
+
+	/// \brief Number of names defined
+	int size() const
+	{
+		return m_names.size();
+	}
+	/// \brief Get a name by index
+	const char* name( int idx) const
+	{
+		return m_names[ idx];
+	}
+
+private:
+	static unsigned char hash( unsigned int seed, const char* name, std::size_t namelen)
+	{
+		unsigned int rt = 2166136261U ^ seed;
+		for (std::size_t ii=0; ii<namelen; ++ii)
+		{
+			rt = (rt ^ (unsigned char)(name[ ii]|32)) * 16777619U;
+		}
+		return (unsigned char)((rt >> 24) ^ (rt >> 8));
+	}
+	bool fill( unsigned int seed);
+
+private:
+	std::vector<const char*> m_names;
+	std::vector<std::size_t> m_sizes;
+	unsigned int m_seed;
+	signed char m_slots[ NofSlots];
+};
+
+}//namespace
+#endif
+
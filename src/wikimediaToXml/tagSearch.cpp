@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Search for the end of tag contents and comments in Wikimedia text
+/// \file tagSearch.cpp
+#include "tagSearch.hpp"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace strus;
+
+const char* strus::findCloseTagStartScalar( const char* si, const char* se)
+{
+	const char* rt = (const char*)std::memchr( si, '<', se - si);
+	for (; rt && rt+1 < se; rt = (const char*)std::memchr( rt+1, '<', se - rt - 1))
+	{
+		if (rt[1] == '/') return rt;
+	}
+	return 0;
+}
+
+const char* strus::findCommentEndScalar( const char* si, const char* se)
+{
+	const char* rt = (const char*)std::memchr( si, '-', se - si);
+	for (; rt && rt+3 <= se; rt = (const char*)std::memchr( rt+1, '-', se - rt - 1))
+	{
+		if (rt[1] == '-' && rt[2] == '>') return rt;
+	}
+	return 0;
+}
+
+#if defined(__SSE2__)
+static int countTrailingZeros( unsigned int mask)
+{
+#if defined(__GNUC__)
+	return __builtin_ctz( mask);
+#else
+	int rt = 0;
+	for (; !(mask & 1); mask >>= 1,++rt){}
+	return rt;
+#endif
+}
+
+//... the searches below compare the characters of the sequence with the source shifted by their offset,
+//	so a '<' not followed by '/' or a '-' not followed by "->" does not interrupt the scan of a block of positions.
+
+static inline __m128i matchCloseTagStart( const char* si)
+{
+	return _mm_and_si128(
+			_mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)si), _mm_set1_epi8( '<')),
+			_mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(si+1)), _mm_set1_epi8( '/')));
+}
+
+static inline __m128i matchCommentEnd( const char* si)
+{
+	return _mm_and_si128(
+			_mm_and_si128(
+				_mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)si), _mm_set1_epi8( '-')),
+				_mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(si+1)), _mm_set1_epi8( '-'))),
+			_mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(si+2)), _mm_set1_epi8( '>')));
+}
+
+//... 32 positions per iteration, the sequence has to be completely before se, so seqlen-1 bytes more are read
+#define FIND_SEQUENCE_SSE2( MATCH, SEQLEN)\
+	for (; se - si >= 32 + SEQLEN - 1; si += 32)\
+	{\
+		unsigned int mask = _mm_movemask_epi8( MATCH( si)) | ((unsigned int)_mm_movemask_epi8( MATCH( si+16)) << 16);\
+		if (mask) return si + countTrailingZeros( mask);\
+	}\
+	if (se - si >= 16 + SEQLEN - 1)\
+	{\
+		unsigned int mask = _mm_movemask_epi8( MATCH( si));\
+		if (mask) return si + countTrailingZeros( mask);\
+		si += 16;\
+	}
+
+static const char* findCloseTagStartSse2_( const char* si, const char* se)
+{
+	FIND_SEQUENCE_SSE2( matchCloseTagStart, 2)
+	return findCloseTagStartScalar( si, se);
+}
+
+static const char* findCommentEndSse2_( const char* si, const char* se)
+{
+	FIND_SEQUENCE_SSE2( matchCommentEnd, 3)
+	return findCommentEndScalar( si, se);
+}
+
+const TagSearchFunction strus::findCloseTagStartSse2 = &findCloseTagStartSse2_;
+const TagSearchFunction strus::findCloseTagStart = &findCloseTagStartSse2_;
+const TagSearchFunction strus::findCommentEndSse2 = &findCommentEndSse2_;
+const TagSearchFunction strus::findCommentEnd = &findCommentEndSse2_;
+#else
+const TagSearchFunction strus::findCloseTagStartSse2 = 0;
+const TagSearchFunction strus::findCloseTagStart = &strus::findCloseTagStartScalar;
+const TagSearchFunction strus::findCommentEndSse2 = 0;
+const TagSearchFunction strus::findCommentEnd = &strus::findCommentEndScalar;
+#endif
+
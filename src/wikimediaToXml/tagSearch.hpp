@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Search for the end of tag contents and comments in Wikimedia text
+/// \file tagSearch.hpp
+#ifndef _STRUS_WIKIPEDIA_TAG_SEARCH_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_TAG_SEARCH_HPP_INCLUDED
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Function searching for a sequence of characters
+/// \param[in] si start of the source to search
+/// \param[in] se end of the source to search, the sequence has to be completely before
+/// \return pointer to the start of the sequence found or NULL if not found
+typedef const char* (*TagSearchFunction)( const char* si, const char* se);
+
+/// \brief Find the start of the next close tag "</", portable implementation
+const char* findCloseTagStartScalar( const char* si, const char* se);
+/// \brief Find the start of the next close tag "</", implementation with SSE2 instructions comparing 32 positions per step
+/// \note NULL if not compiled for a target supporting SSE2
+extern const TagSearchFunction findCloseTagStartSse2;
+/// \brief Best implementation of the search for close tags available
+extern const TagSearchFunction findCloseTagStart;
+
+/// \brief Find the end of a comment "-->", portable implementation
+const char* findCommentEndScalar( const char* si, const char* se);
+/// \brief Find the end of a comment "-->", implementation with SSE2 instructions comparing 32 positions per step
+/// \note NULL if not compiled for a target supporting SSE2
+extern const TagSearchFunction findCommentEndSse2;
+/// \brief Best implementation of the search for the end of comments available
+extern const TagSearchFunction findCommentEnd;
+
+}//namespace
+#endif
+
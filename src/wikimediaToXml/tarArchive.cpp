@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Writing output files into gzip compressed tar archives
+/// \file tarArchive.cpp
+#include "tarArchive.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <ctime>
+
+using namespace strus;
+
+enum {TarBlockSize=512};
+
+TarGzWriter::TarGzWriter( const std::string& filename_)
+	:m_filename(filename_),m_tmpfilename(filename_ + ".tmp"),m_file(0),m_size(0),m_mtime((long)::time(NULL))
+{
+	m_file = ::gzopen( m_tmpfilename.c_str(), "wb");
+	if (!m_file)
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( "failed to open archive '%s' for writing: %s", m_tmpfilename.c_str(), ec ? ::strerror(ec) : "out of memory"));
+	}
+}
+
+TarGzWriter::~TarGzWriter()
+{
+	if (m_file) ::gzclose( m_file);
+}
+
+void TarGzWriter::writeBlocks( const char* data, std::size_t datasize)
+{
+	static const char padding[ TarBlockSize] = {0};
+	if (datasize && (std::size_t)::gzwrite( m_file, data, datasize) != datasize)
+	{
+		int ec;
+		const char* msg = ::gzerror( m_file, &ec);
+		throw std::runtime_error( strus::string_format( "failed to write archive '%s': %s", m_tmpfilename.c_str(), ec == Z_ERRNO ? ::strerror(errno) : msg));
+	}
+	std::size_t padsize = (TarBlockSize - datasize % TarBlockSize) % TarBlockSize;
+	if (padsize && (std::size_t)::gzwrite( m_file, padding, padsize) != padsize)
+	{
+		int ec;
+		const char* msg = ::gzerror( m_file, &ec);
+		throw std::runtime_error( strus::string_format( "failed to write archive '%s': %s", m_tmpfilename.c_str(), ec == Z_ERRNO ? ::strerror(errno) : msg));
+	}
+	m_size += datasize + padsize;
+}
+
+static void printOctal( char* dest, std::size_t destsize, unsigned long value)
+{
+	//... zero padded octal number with terminating null character
+	std::snprintf( dest, destsize, "%0*lo", (int)destsize-1, value);
+}
+
+void TarGzWriter::writeHeader( const std::string& name, std::size_t contentsize, char typeflag)
+{
+	char header[ TarBlockSize];
+	std::memset( header, 0, sizeof(header));
+	if (name.size() <= 100)
+	{
+		std::memcpy( header, name.c_str(), name.size());
+	}
+	else
+	{
+		//... split the name into prefix and name, the caller ensures with a GNU long name entry that this is possible or not needed
+		std::string::size_type sep = name.rfind( '/', 155);
+		if (sep == std::string::npos || name.size() - sep - 1 > 100)
+		{
+			std::memcpy( header, name.c_str(), 100);
+		}
+		else
+		{
+			std::memcpy( header, name.c_str() + sep + 1, name.size() - sep - 1);
+			std::memcpy( header + 345, name.c_str(), sep);
+		}
+	}
+	printOctal( header + 100, 8, 0644);			//... mode
+	printOctal( header + 108, 8, 0);			//... uid
+	printOctal( header + 116, 8, 0);			//... gid
+	printOctal( header + 124, 12, contentsize);		//... size
+	printOctal( header + 136, 12, m_mtime);			//... mtime
+	std::memset( header + 148, ' ', 8);			//... checksum computed with spaces
+	header[ 156] = typeflag;
+	std::memcpy( header + 257, "ustar", 6);			//... magic
+	std::memcpy( header + 263, "00", 2);			//... version
+	unsigned int checksum = 0;
+	for (int hi=0; hi < TarBlockSize; ++hi) checksum += (unsigned char)header[ hi];
+	std::snprintf( header + 148, 8, "%06o", checksum);
+	header[ 155] = ' ';
+	writeBlocks( header, sizeof(header));
+}
+
+void TarGzWriter::addFile( const std::string& name, const std::string& content)
+{
+	if (!m_file) throw std::runtime_error( strus::string_format( "write to closed archive '%s'", m_filename.c_str()));
+	if (name.size() > 100)
+	{
+		std::string::size_type sep = name.rfind( '/', 155);
+		if (sep == std::string::npos || name.size() - sep - 1 > 100)
+		{
+			//... GNU long name entry, the name is the content of a pseudo file preceding the file
+			writeHeader( "././@LongLink", name.size() + 1, 'L');
+			writeBlocks( name.c_str(), name.size() + 1);
+		}
+	}
+	writeHeader( name, content.size(), '0');
+	writeBlocks( content.c_str(), content.size());
+}
+
+void TarGzWriter::close()
+{
+	if (!m_file) return;
+	char endblocks[ 2 * TarBlockSize];
+	std::memset( endblocks, 0, sizeof(endblocks));
+	writeBlocks( endblocks, sizeof(endblocks));
+	int res = ::gzclose( m_file);
+	m_file = 0;
+	if (res != Z_OK) throw std::runtime_error( strus::string_format( "failed to close archive '%s' (error %d)", m_tmpfilename.c_str(), res));
+	if (0 != std::rename( m_tmpfilename.c_str(), m_filename.c_str()))
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( "failed to rename archive '%s': %s", m_tmpfilename.c_str(), ::strerror(ec)));
+	}
+}
+
+OutputArchives::OutputArchives( const std::string& outputdir_, int nofSlots_, std::size_t maxArchiveSize_)
+	:m_outputdir(outputdir_),m_nofSlots(nofSlots_ > 0 ? nofSlots_ : 1),m_maxArchiveSize(maxArchiveSize_),m_slots(0)
+{
+	m_slots = new Slot[ m_nofSlots];
+}
+
+OutputArchives::~OutputArchives()
+{
+	for (int si=0; si < m_nofSlots; ++si)
+	{
+		delete m_slots[ si].archive;
+	}
+	delete [] m_slots;
+}
+
+void OutputArchives::write( int fileCounter, const std::string& name, const std::string& content)
+{
+	Slot& slot = m_slots[ fileCounter % m_nofSlots];
+	strus::unique_lock lock( slot.mutex);
+	if (slot.archive && slot.lastFileCounter != fileCounter && slot.archive->size() >= m_maxArchiveSize)
+	{
+		//... start a new archive only with a new document, to keep the files of a document together
+		TarGzWriter* archive = slot.archive;
+		slot.archive = 0;
+		try
+		{
+			archive->close();
+		}
+		catch (const std::runtime_error&)
+		{
+			delete archive;
+			throw;
+		}
+		delete archive;
+	}
+	if (!slot.archive)
+	{
+		std::string filename = strus::joinFilePath( m_outputdir, strus::string_format( "%03d_%05d.tar.gz", fileCounter % m_nofSlots, slot.seqno++));
+		slot.archive = new TarGzWriter( filename);
+	}
+	slot.lastFileCounter = fileCounter;
+	slot.archive->addFile( name, content);
+}
+
+void OutputArchives::close()
+{
+	for (int si=0; si < m_nofSlots; ++si)
+	{
+		strus::unique_lock lock( m_slots[ si].mutex);
+		if (m_slots[ si].archive)
+		{
+			m_slots[ si].archive->close();
+			delete m_slots[ si].archive;
+			m_slots[ si].archive = 0;
+		}
+	}
+}
+
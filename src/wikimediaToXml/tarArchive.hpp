@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Writing output files into gzip compressed tar archives
+/// \file tarArchive.hpp
+#ifndef _STRUS_WIKIPEDIA_TAR_ARCHIVE_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_TAR_ARCHIVE_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <zlib.h>
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Writer of a gzip compressed tar archive (ustar format, GNU long names for member names not fitting into the header)
+/// \remark The archive is written to a file with the extension ".tmp" renamed to the name of the archive when closed, so that only complete archives are visible
+class TarGzWriter
+{
+public:
+	/// \brief Constructor
+	/// \param[in] filename_ name of the archive file
+	explicit TarGzWriter( const std::string& filename_);
+	/// \brief Destructor, leaves the temporary file of an archive not closed
+	~TarGzWriter();
+
+	/// \brief Add a file to the archive
+	/// \param[in] name name of the file in the archive
+	/// \param[in] content content of the file
+	void addFile( const std::string& name, const std::string& content);
+	/// \brief Terminate the archive and make it visible under its name
+	void close();
+
+	/// \brief Number of bytes of the tar archive written (uncompressed)
+	std::size_t size() const		{return m_size;}
+
+private:
+	void writeHeader( const std::string& name, std::size_t contentsize, char typeflag);
+	void writeBlocks( const char* data, std::size_t datasize);
+
+private:
+	std::string m_filename;
+	std::string m_tmpfilename;
+	gzFile m_file;
+	std::size_t m_size;
+	long m_mtime;
+};
+
+/// \brief Set of gzip compressed tar archives the output files of the conversion are written to
+/// \remark The output files of a document are written to the archive of slot (document number modulo the number of slots).
+///	The archive of a slot is replaced by a new one, when it reached the maximum size at the start of a document.
+///	Archives are named <slot>_<sequence number>.tar.gz in the output directory.
+class OutputArchives
+{
+public:
+	/// \brief Constructor
+	/// \param[in] outputdir_ directory the archives are written to
+	/// \param[in] nofSlots_ number of archives written in parallel (number of conversion threads to avoid contention)
+	/// \param[in] maxArchiveSize_ size of an archive (uncompressed) from where a new archive is started with the next document
+	OutputArchives( const std::string& outputdir_, int nofSlots_, std::size_t maxArchiveSize_);
+	~OutputArchives();
+
+	/// \brief Write an output file of a document (thread safe)
+	/// \param[in] fileCounter number of the document
+	/// \param[in] name name of the file in the archive
+	/// \param[in] content content of the file
+	void write( int fileCounter, const std::string& name, const std::string& content);
+
+	/// \brief Close all archives
+	void close();
+
+private:
+	struct Slot
+	{
+		strus::mutex mutex;
+		TarGzWriter* archive;
+		int seqno;
+		int lastFileCounter;
+
+		Slot()
+			:mutex(),archive(0),seqno(0),lastFileCounter(-1){}
+	};
+
+private:
+	std::string m_outputdir;
+	int m_nofSlots;
+	std::size_t m_maxArchiveSize;
+	Slot* m_slots;
+};
+
+}//namespace
+#endif
+
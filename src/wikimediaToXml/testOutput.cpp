@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Comparing the output of a conversion with an expected result (option --test)
+/// \file testOutput.cpp
+#include "testOutput.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+using namespace strus;
+
+TestOutput::TestOutput( const std::string& expectedFilename_)
+	:m_mutex(),m_expectedFilename(expectedFilename_),m_expectedFile(0),m_bufpos(0),m_bufsize(0)
+	,m_dispatched(),m_outputs(),m_trailer(),m_line(1),m_skipOutputLF(false),m_failed(false)
+{
+	m_expectedFile = std::fopen( m_expectedFilename.c_str(), "rb");
+	if (!m_expectedFile)
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( "failed to read expected file '%s' for testing (option --test <expected file>): %s", m_expectedFilename.c_str(), ::strerror(ec)));
+	}
+}
+
+TestOutput::~TestOutput()
+{
+	if (m_expectedFile) std::fclose( m_expectedFile);
+}
+
+void TestOutput::dispatched( int docno)
+{
+	strus::unique_lock lock( m_mutex);
+	m_dispatched.insert( docno);
+}
+
+void TestOutput::write( int docno, const std::string& content)
+{
+	strus::unique_lock lock( m_mutex);
+	m_outputs[ docno].append( content);
+}
+
+void TestOutput::completed( int docno)
+{
+	strus::unique_lock lock( m_mutex);
+	m_dispatched.erase( docno);
+	flush( false);
+}
+
+void TestOutput::writeTrailer( const std::string& content)
+{
+	strus::unique_lock lock( m_mutex);
+	m_trailer.append( content);
+}
+
+void TestOutput::finish()
+{
+	strus::unique_lock lock( m_mutex);
+	flush( true);
+	compare( m_trailer);
+	m_trailer.clear();
+	if (!m_failed && peekExpected() != EOF) m_failed = true;
+	if (m_failed)
+	{
+		throw std::runtime_error( strus::string_format( "test outputs differ at line %d", m_line));
+	}
+}
+
+void TestOutput::flush( bool all)
+{
+	//... documents dispatched later have higher numbers, so the outputs below the first document not completed are final
+	std::map<int,std::string>::iterator oi = m_outputs.begin();
+	while (oi != m_outputs.end() && (all || m_dispatched.empty() || oi->first < *m_dispatched.begin()))
+	{
+		compare( oi->second);
+		m_outputs.erase( oi++);
+	}
+}
+
+int TestOutput::peekExpected()
+{
+	if (m_bufpos == m_bufsize)
+	{
+		m_bufpos = 0;
+		m_bufsize = std::fread( m_buffer, 1, sizeof(m_buffer), m_expectedFile);
+		if (m_bufsize == 0)
+		{
+			if (std::ferror( m_expectedFile)) throw std::runtime_error( strus::string_format( "failed to read expected file '%s' for testing (option --test <expected file>)", m_expectedFilename.c_str()));
+			return EOF;
+		}
+	}
+	return (unsigned char)m_buffer[ m_bufpos];
+}
+
+int TestOutput::nextExpected()
+{
+	int rt = peekExpected();
+	if (rt != EOF) ++m_bufpos;
+	return rt;
+}
+
+void TestOutput::compare( const std::string& output)
+{
+	//... line ends are compared as equal, independent of the use of carriage return and line feed
+	std::string::const_iterator oi = output.begin(), oe = output.end();
+	for (; oi != oe && !m_failed; ++oi)
+	{
+		if (m_skipOutputLF)
+		{
+			m_skipOutputLF = false;
+			if (*oi == '\n') continue;
+		}
+		int ec = peekExpected();
+		if ((*oi == '\r' || *oi == '\n') && (ec == '\r' || ec == '\n'))
+		{
+			nextExpected();
+			if (ec == '\r' && peekExpected() == '\n') nextExpected();
+			m_skipOutputLF = (*oi == '\r');
+			++m_line;
+		}
+		else if (ec != (unsigned char)*oi)
+		{
+			m_failed = true;
+		}
+		else
+		{
+			nextExpected();
+		}
+	}
+}
+
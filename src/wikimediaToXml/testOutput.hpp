@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Comparing the output of a conversion with an expected result (option --test)
+/// \file testOutput.hpp
+#ifndef _STRUS_WIKIPEDIA_TEST_OUTPUT_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_TEST_OUTPUT_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <string>
+#include <map>
+#include <set>
+#include <cstdio>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Collects the outputs of the documents of a conversion and compares them in the order of the document numbers with an expected result
+/// \remark Outputs of documents completed out of order by different threads are buffered, until all documents with a smaller number are completed.
+///	Then they are compared with the expected result read sequentially from the file, so neither the whole output nor the expected result is held in memory.
+///	The document numbers are expected to be dispatched in ascending order.
+class TestOutput
+{
+public:
+	/// \brief Constructor, throws if the file with the expected result can not be opened
+	/// \param[in] expectedFilename_ name of the file with the expected result
+	explicit TestOutput( const std::string& expectedFilename_);
+	~TestOutput();
+
+	/// \brief Notify that a document has been dispatched for processing
+	/// \param[in] docno document number
+	void dispatched( int docno);
+	/// \brief Add an output of a document (thread safe)
+	/// \param[in] docno document number
+	/// \param[in] content output to add
+	void write( int docno, const std::string& content);
+	/// \brief Notify that a document has been completed, compares the outputs of the documents completed without gap before (thread safe)
+	/// \param[in] docno document number
+	void completed( int docno);
+	/// \brief Add an output not belonging to a document, compared after the outputs of all documents
+	/// \param[in] content output to add
+	void writeTrailer( const std::string& content);
+
+	/// \brief Compare all outputs not compared yet and the end of the expected result, throws if the outputs differ
+	void finish();
+
+private:
+	TestOutput( const TestOutput&);		//... non copyable
+	void operator=( const TestOutput&);	//... non copyable
+
+	void flush( bool all);
+	void compare( const std::string& output);
+	int peekExpected();
+	int nextExpected();
+
+private:
+	strus::mutex m_mutex;
+	std::string m_expectedFilename;
+	std::FILE* m_expectedFile;
+	char m_buffer[ 1<<16];				//... buffer of the expected result read
+	std::size_t m_bufpos;
+	std::size_t m_bufsize;
+	std::set<int> m_dispatched;			//... documents dispatched and not completed yet
+	std::map<int,std::string> m_outputs;		//... outputs of documents not compared yet
+	std::string m_trailer;
+	int m_line;					//... current line of the expected result
+	bool m_skipOutputLF;				//... output ended with a carriage return, to be matched with a following line feed
+	bool m_failed;					//... outputs differ
+};
+
+}//namespace
+#endif
+
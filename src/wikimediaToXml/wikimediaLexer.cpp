@@ -10,6 +10,7 @@
 /// \file wikimediaLexer.cpp
 #include "wikimediaLexer.hpp"
 #include "outputString.hpp"
+#include "tagSearch.hpp"
 #include "strus/base/string_conv.hpp"
 #include "strus/base/utf8.hpp"
 #include <string>
@@ -57,19 +58,10 @@ static bool isEqual( const char* id, const char* src, std::size_t size)
 	return ii==size;
 }
 
-static const char* findPattern( char const* si, const char* se, const char* pattern)
+static const char* skipToCommentEnd( char const* si, const char* se)
 {
-	int plen = std::strlen( pattern);
-	for (;;)
-	{
-		const char* rt = (const char*)std::memchr( si, pattern[0], se-si);
-		if (!rt) return 0;
-		if (se - rt >= plen && 0==std::memcmp( rt, pattern, plen))
-		{
-			return rt + plen;
-		}
-		si = rt+1;
-	}
+	const char* rt = strus::findCommentEnd( si, se);
+	return rt ? (rt + 3) : 0;
 }
 
 static char const* skipToEoln( char const* si, char const* se)
@@ -155,7 +147,7 @@ static char const* skipSpacesAndComments( char const* si, char const* se)
 		si = skipSpaces( si, se);
 		if (si < se && si[0] == '<' && si[1] == '!' && si[2] == '-' && si[3] == '-')
 		{
-			const char* end = findPattern( si+4, se, "-->");
+			const char* end = skipToCommentEnd( si+4, se);
 			if (end) si = end; else return si;
 		}
 		else
@@ -188,12 +180,12 @@ static bool parseIdentifier( std::string& res, char const*& si, char const* se,
 
 static std::string parseTagContent( const char* tagname, char const*& si, const char* se)
 {
-	const char* end = (const char*)std::memchr( si, '<', se-si);
-	for (; end && end-si < 256 && end+1 < se; end = (const char*)std::memchr( end+1, '<', se-end-1))
+	//... only close tags starting in the first 256 bytes of the content are considered
+	const char* searchend = (se - si > 257) ? (si + 257) : se;
+	const char* end = strus::findCloseTagStart( si, searchend);
+	for (; end; end = strus::findCloseTagStart( end+1, searchend))
 	{
-		const char* tg = end+1;
-		if (*tg != '/') continue;
-		++tg;
+		const char* tg = end+2;
 		while (*tg && isSpace(*tg)) ++tg;
 		const char* name = tg;
 		while (tg < se && isAlpha(*tg)) ++tg;
@@ -283,6 +275,76 @@ enum TagType {
 	TagBr
 };
 
+struct TagDef
+{
+	const char* name;
+	TagType openType;
+	TagType closeType;
+	bool openOnly;		//... only open tags are recognized, the content up to the close tag is skipped and the tag returned as comment
+};
+
+static const TagDef g_tagDefs[] = {
+	{"nowiki", TagNoWikiOpen, TagNoWikiClose, false},
+	{"timestamp", TagTimestampOpen, TagTimestampClose, false},
+	{"code", TagCodeOpen, TagCodeClose, false},
+	{"var", TagVarOpen, TagVarClose, false},
+	{"tt", TagTtOpen, TagTtClose, false},
+	{"syntaxhighlight", TagSyntaxHighlightOpen, TagSyntaxHighlightClose, false},
+	{"source", TagSourceOpen, TagSourceClose, false},
+	{"math", TagMathOpen, TagMathClose, false},
+	{"chem", TagChemOpen, TagChemClose, false},
+	{"sup", TagSupOpen, TagSupClose, false},
+	{"sub", TagSubOpen, TagSubClose, false},
+	{"pre", TagPreOpen, TagPreClose, false},
+	{"ins", TagInsOpen, TagInsClose, false},
+	{"imagemap", TagImageMapOpen, TagImageMapClose, false},
+	{"ref", TagRefOpen, TagRefClose, false},
+	{"blockquote", TagBlockquoteOpen, TagBlockquoteClose, false},
+	{"cite", TagCiteOpen, TagCiteClose, false},
+	{"poem", TagPoemOpen, TagPoemClose, false},
+	{"div", TagDivOpen, TagDivClose, false},
+	{"span", TagSpanOpen, TagSpanClose, false},
+	{"abbr", TagAbbrOpen, TagAbbrClose, false},
+	{"center", TagCenterOpen, TagCenterClose, false},
+	{"small", TagSmallOpen, TagSmallClose, false},
+	{"big", TagBigOpen, TagBigClose, false},
+	{"u", TagUOpen, TagUClose, false},
+	{"s", TagSOpen, TagSClose, false},
+	{"q", TagQOpen, TagQClose, false},
+	{"i", TagIOpen, TagIClose, false},
+	{"p", TagPOpen, TagPClose, false},
+	{"gallery", TagGalleryOpen, TagGalleryClose, false},
+	{"br", TagBr, TagBr, false},
+	{"ol", TagBr, TagBr, false},
+	{"ul", TagBr, TagBr, false},
+	{"li", TagLiOpen, TagLiClose, false},
+	{"tr", TagTrOpen, TagTrClose, false},
+	{"hr", TagHrOpen, TagHrClose, false},
+	{"td", TagTdOpen, TagTdClose, false},
+	{"noinclude", TagComment, TagComment, true},
+	{"score", TagComment, TagComment, true},
+	{"timeline", TagComment, TagComment, true},
+	{"please", TagComment, TagComment, false},
+	{0, UnknwownTagType, UnknwownTagType, false}
+};
+
+class TagDefNameTable
+	:public TagNameTable
+{
+public:
+	TagDefNameTable()
+	{
+		for (const TagDef* di = g_tagDefs; di->name; ++di) add( di->name);
+	}
+};
+
+static const TagDefNameTable g_tagNameTable;
+
+const TagNameTable& strus::wikimediaTagNameTable()
+{
+	return g_tagNameTable;
+}
+
 static bool findEndTag( char const*& si, const char* se, int maxlen)
 {
 	int ti = 0;
@@ -298,18 +360,6 @@ static bool findEndTag( char const*& si, const char* se, int maxlen)
 	return false;
 }
 
-static bool tryParseTag( const char* tagnam, char const*& si, const char* se)
-{
-	const char* start = si;
-	int ti = 0;
-	for (;si < se && tagnam[ti] && tagnam[ti] == (*si|32); ++si,++ti){}
-	if (!tagnam[ti] && (*si == ' ' || *si == '/' || *si == '>') && findEndTag( si, se, 256))
-	{
-		return true;
-	}
-	si = start;
-	return false;
-}
 
 static bool tryParseAnyTag( char const*& si, const char* se)
 {
@@ -389,7 +439,7 @@ static TagType parseTagType( char const*& si, const char* se)
 	si++;
 	if (si < se && si[0] == '!' && si[1] == '-' && si[2] == '-')
 	{
-		const char* end = findPattern( si+2, se, "-->");
+		const char* end = skipToCommentEnd( si+2, se);
 		if (!end) throw std::runtime_error( std::string("unclosed comment tag") + ": " + outputString( start, se));
 		si = end;
 		return TagComment;
@@ -412,49 +462,20 @@ static TagType parseTagType( char const*& si, const char* se)
 				//.... immediate close tags not encolsing any content are considered unimportant for text retrieval and thus marked as comments.
 			}
 		}
-		if (tryParseTag( "nowiki", si, se)) return open ? TagNoWikiOpen : TagNoWikiClose;
-		else if (tryParseTag( "timestamp", si, se)) return open ? TagTimestampOpen : TagTimestampClose;
-		else if (tryParseTag( "code", si, se)) return open ? TagCodeOpen : TagCodeClose;
-		else if (tryParseTag( "var", si, se)) return open ? TagVarOpen : TagVarClose;
-		else if (tryParseTag( "tt", si, se)) return open ? TagTtOpen : TagTtClose;
-		else if (tryParseTag( "syntaxhighlight", si, se)) return open ? TagSyntaxHighlightOpen : TagSyntaxHighlightClose;
-		else if (tryParseTag( "source", si, se)) return open ? TagSourceOpen : TagSourceClose;
-		else if (tryParseTag( "math", si, se)) return open ? TagMathOpen : TagMathClose;
-		else if (tryParseTag( "chem", si, se)) return open ? TagChemOpen : TagChemClose;
-		else if (tryParseTag( "sup", si, se)) return open ? TagSupOpen : TagSupClose;
-		else if (tryParseTag( "sub", si, se)) return open ? TagSubOpen : TagSubClose;
-		else if (tryParseTag( "pre", si, se)) return open ? TagPreOpen : TagPreClose;
-		else if (tryParseTag( "ins", si, se)) return open ? TagInsOpen : TagInsClose;
-		else if (tryParseTag( "imagemap", si, se)) return open ? TagImageMapOpen : TagImageMapClose;
-		else if (tryParseTag( "ref", si, se)) return open ? TagRefOpen : TagRefClose;
-		else if (tryParseTag( "blockquote", si, se)) return open ? TagBlockquoteOpen : TagBlockquoteClose;
-		else if (tryParseTag( "cite", si, se)) return open ? TagCiteOpen : TagCiteClose;
-		else if (tryParseTag( "poem", si, se)) return open ? TagPoemOpen : TagPoemClose;
-		else if (tryParseTag( "div", si, se)) return open ? TagDivOpen : TagDivClose;
-		else if (tryParseTag( "span", si, se)) return open ? TagSpanOpen : TagSpanClose;
-		else if (tryParseTag( "abbr", si, se)) return open ? TagAbbrOpen : TagAbbrClose;
-		else if (tryParseTag( "span", si, se)) return open ? TagSpanOpen : TagSpanClose;
-		else if (tryParseTag( "center", si, se)) return open ? TagCenterOpen : TagCenterClose;
-		else if (tryParseTag( "small", si, se)) return open ? TagSmallOpen : TagSmallClose;
-		else if (tryParseTag( "big", si, se)) return open ? TagBigOpen : TagBigClose;
-		else if (tryParseTag( "u", si, se)) return open ? TagUOpen : TagUClose;
-		else if (tryParseTag( "s", si, se)) return open ? TagSOpen : TagSClose;
-		else if (tryParseTag( "q", si, se)) return open ? TagQOpen : TagQClose;
-		else if (tryParseTag( "i", si, se)) return open ? TagIOpen : TagIClose;
-		else if (tryParseTag( "p", si, se)) return open ? TagPOpen : TagPClose;
-		else if (tryParseTag( "gallery", si, se)) return open ? TagGalleryOpen : TagGalleryClose;
-		else if (tryParseTag( "br", si, se)) return open ? TagBr : TagBr;
-		else if (tryParseTag( "ol", si, se)) return open ? TagBr : TagBr;
-		else if (tryParseTag( "ul", si, se)) return open ? TagBr : TagBr;
-		else if (tryParseTag( "li", si, se)) return open ? TagLiOpen : TagLiClose;
-		else if (tryParseTag( "tr", si, se)) return open ? TagTrOpen : TagTrClose;
-		else if (tryParseTag( "hr", si, se)) return open ? TagHrOpen : TagHrClose;
-		else if (tryParseTag( "td", si, se)) return open ? TagTdOpen : TagTdClose;
-		else if (open && tryParseTag( "noinclude", si, se)) {(void)parseTagContent( "noinclude", si, se); return TagComment;}
-		else if (open && tryParseTag( "score", si, se)) {(void)parseTagContent( "score", si, se); return TagComment;}
-		else if (open && tryParseTag( "timeline", si, se)) {(void)parseTagContent( "timeline", si, se); return TagComment;}
-		else if (tryParseTag( "please", si, se)) return open ? TagComment : TagComment;
-		else if (tryParseAnyTag( si, se)) return TagBr;
+		const char* ti = si;
+		for (; ti < se && isAlpha(*ti) && ti - si <= TagNameTable::MaxNameLength; ++ti){}
+		int tagidx = g_tagNameTable.find( si, ti - si);
+		if (tagidx >= 0 && (open || !g_tagDefs[ tagidx].openOnly) && ti < se && (*ti == ' ' || *ti == '/' || *ti == '>') && findEndTag( ti, se, 256))
+		{
+			const TagDef& def = g_tagDefs[ tagidx];
+			si = ti;
+			if (def.openOnly)
+			{
+				(void)parseTagContent( def.name, si, se);
+			}
+			return open ? def.openType : def.closeType;
+		}
+		if (tryParseAnyTag( si, se)) return TagBr;
 		else if (tryParseTagDefStart( si, se)) return TagBr;
 	}
 	si = start + 1;
@@ -1073,7 +1094,40 @@ static bool compareFollowString( const char* si, const char* se, const char* str
 	return *xi == '\0';
 }
 
-WikimediaLexem WikimediaLexer::next()
+static int countTrailingZeros( unsigned int mask)
+{
+#if defined(__GNUC__)
+	return __builtin_ctz( mask);
+#else
+	int rt = 0;
+	for (; !(mask & 1); mask >>= 1,++rt){}
+	return rt;
+#endif
+}
+
+void WikimediaLexer::skipPlainText()
+{
+	//... the stop mask does not depend on the state of the lexer, so it stays valid when positions are revisited after unget
+	if (!m_stopMaskFunc) return;
+	for (;;)
+	{
+		if (m_si < m_stopBase || m_si >= m_stopBase + PlainTextStride)
+		{
+			if (m_se - m_si < PlainTextWindow) return;
+			m_stopBase = m_si;
+			m_stopMask = m_stopMaskFunc( m_si);
+		}
+		unsigned int mask = m_stopMask >> (m_si - m_stopBase);
+		if (mask)
+		{
+			m_si += countTrailingZeros( mask);
+			return;
+		}
+		m_si = m_stopBase + PlainTextStride;
+	}
+}
+
+bool WikimediaLexer::scan()
 {
 	m_prev_si = m_si;
 	const char* start = m_si;
@@ -1081,6 +1135,8 @@ WikimediaLexem WikimediaLexer::next()
 	{
 	while (m_si < m_se)
 	{
+		if (m_deadline) m_deadline->poll();
+		skipPlainText();
 		if ((unsigned char)*m_si >= 128)
 		{
 			int chlen = strus::utf8charlen( *m_si);
@@ -1090,13 +1146,13 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			int tcnt = countAndSkip( m_si, m_se, '=', 7);
 			if (tcnt == m_curHeading)
 			{
 				m_curHeading = tcnt;
-				return WikimediaLexem( WikimediaLexem::CloseHeading, tcnt, "");
+				return emit( WikimediaLexem::CloseHeading, tcnt, "");
 			}
 			else
 			{
@@ -1107,7 +1163,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			if (m_si+8 < m_se && (0==std::memcmp( m_si, "<http://", 8) || 0==std::memcmp( m_si, "<https://", 9)))
 			{
@@ -1118,11 +1174,11 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					std::string url( start+1, m_si-(start+1));
 					++m_si;
-					return WikimediaLexem( WikimediaLexem::Url, 0, url);
+					return emit( WikimediaLexem::Url, 0, url);
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::Error, 0, std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40));
+					return emit( WikimediaLexem::Error, 0, std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40));
 				}
 			}
 			if (m_si+1 < m_se && (isAlpha( m_si[1]) || m_si[1] == '/' || m_si[1] == '!'))
@@ -1130,155 +1186,155 @@ WikimediaLexem WikimediaLexer::next()
 				switch (parseTagType( m_si, m_se))
 				{
 					case UnknwownTagType:
-						return WikimediaLexem( WikimediaLexem::Error, 0, std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40));
+						return emit( WikimediaLexem::Error, 0, std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40));
 					case TagNoWikiOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "nowiki", m_si, m_se));
+						return emit( WikimediaLexem::NoWiki, 0, parseTagContent( "nowiki", m_si, m_se));
 					case TagNoWikiClose:
 						start = m_si;
 						break;
 					case TagTimestampOpen:
-						return WikimediaLexem( WikimediaLexem::Timestamp, 0, parseTagContent( "timestamp", m_si, m_se));
+						return emit( WikimediaLexem::Timestamp, 0, parseTagContent( "timestamp", m_si, m_se));
 					case TagTimestampClose:
 						start = m_si;
 						break;
 					case TagCodeOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "code", m_si, m_se));
+						return emit( WikimediaLexem::NoWiki, 0, parseTagContent( "code", m_si, m_se));
 					case TagCodeClose:
 						start = m_si;
 						break;
 					case TagVarOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "var", m_si, m_se));
+						return emit( WikimediaLexem::NoWiki, 0, parseTagContent( "var", m_si, m_se));
 					case TagVarClose:
 						start = m_si;
 						break;
 					case TagTtOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "tt", m_si, m_se));
+						return emit( WikimediaLexem::NoWiki, 0, parseTagContent( "tt", m_si, m_se));
 					case TagTtClose:
 						start = m_si;
 						break;
 					case TagSourceOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "source", m_si, m_se));
+						return emit( WikimediaLexem::NoWiki, 0, parseTagContent( "source", m_si, m_se));
 					case TagSourceClose:
 						start = m_si;
 						break;
 					case TagSyntaxHighlightOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "syntaxhighlight", m_si, m_se));
+						return emit( WikimediaLexem::NoWiki, 0, parseTagContent( "syntaxhighlight", m_si, m_se));
 					case TagSyntaxHighlightClose:
 						start = m_si;
 						break;
 					case TagMathOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "math", m_si, m_se));
+						return emit( WikimediaLexem::Math, 0, parseTagContent( "math", m_si, m_se));
 					case TagMathClose:
 						break;
 					case TagChemOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "chem", m_si, m_se));
+						return emit( WikimediaLexem::Math, 0, parseTagContent( "chem", m_si, m_se));
 					case TagChemClose:
 						break;
 					case TagSupOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "sup", m_si, m_se));
+						return emit( WikimediaLexem::Math, 0, parseTagContent( "sup", m_si, m_se));
 					case TagSupClose:
 						break;
 					case TagSubOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "sub", m_si, m_se));
+						return emit( WikimediaLexem::Math, 0, parseTagContent( "sub", m_si, m_se));
 					case TagSubClose:
 						break;
 					case TagGalleryOpen:
-						return WikimediaLexem( WikimediaLexem::OpenRef);
+						return emit( WikimediaLexem::OpenRef);
 					case TagGalleryClose:
-						return WikimediaLexem( WikimediaLexem::CloseRef);
+						return emit( WikimediaLexem::CloseRef);
 					case TagImageMapOpen:
-						return WikimediaLexem( WikimediaLexem::OpenRef);
+						return emit( WikimediaLexem::OpenRef);
 					case TagImageMapClose:
-						return WikimediaLexem( WikimediaLexem::CloseRef);
+						return emit( WikimediaLexem::CloseRef);
 					case TagRefOpen:
-						return WikimediaLexem( WikimediaLexem::OpenRef);
+						return emit( WikimediaLexem::OpenRef);
 					case TagRefClose:
-						return WikimediaLexem( WikimediaLexem::CloseRef);
+						return emit( WikimediaLexem::CloseRef);
 					case TagSpanOpen:
-						return WikimediaLexem( WikimediaLexem::OpenSpan);
+						return emit( WikimediaLexem::OpenSpan);
 					case TagSpanClose:
-						return WikimediaLexem( WikimediaLexem::CloseSpan);
+						return emit( WikimediaLexem::CloseSpan);
 					case TagAbbrOpen:
-						return WikimediaLexem( WikimediaLexem::OpenSpan);
+						return emit( WikimediaLexem::OpenSpan);
 					case TagAbbrClose:
-						return WikimediaLexem( WikimediaLexem::CloseSpan);
+						return emit( WikimediaLexem::CloseSpan);
 					case TagCenterOpen:
-						return WikimediaLexem( WikimediaLexem::OpenSpan);
+						return emit( WikimediaLexem::OpenSpan);
 					case TagCenterClose:
-						return WikimediaLexem( WikimediaLexem::CloseSpan);
+						return emit( WikimediaLexem::CloseSpan);
 					case TagSmallOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagSmallClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagBigOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagBigClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagUOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagUClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagLiOpen:
-						return WikimediaLexem( WikimediaLexem::ListItem);
+						return emit( WikimediaLexem::ListItem);
 					case TagLiClose:
-						return WikimediaLexem( WikimediaLexem::EndOfLine);
+						return emit( WikimediaLexem::EndOfLine);
 					case TagTrOpen:
-						return WikimediaLexem( WikimediaLexem::TableRowDelim);
+						return emit( WikimediaLexem::TableRowDelim);
 					case TagTrClose:
-						return WikimediaLexem( WikimediaLexem::EndOfLine);
+						return emit( WikimediaLexem::EndOfLine);
 					case TagHrOpen:
-						return WikimediaLexem( WikimediaLexem::TableHeadDelim);
+						return emit( WikimediaLexem::TableHeadDelim);
 					case TagHrClose:
-						return WikimediaLexem( WikimediaLexem::EndOfLine);
+						return emit( WikimediaLexem::EndOfLine);
 					case TagTdOpen:
-						return WikimediaLexem( WikimediaLexem::TableColDelim);
+						return emit( WikimediaLexem::TableColDelim);
 					case TagTdClose:
-						return WikimediaLexem( WikimediaLexem::EndOfLine);
+						return emit( WikimediaLexem::EndOfLine);
 					case TagSOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagSClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagQOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagQClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagPreOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagPreClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagInsOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagInsClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagIOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagIClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagPOpen:
-						return WikimediaLexem( WikimediaLexem::OpenFormat);
+						return emit( WikimediaLexem::OpenFormat);
 					case TagPClose:
-						return WikimediaLexem( WikimediaLexem::CloseFormat);
+						return emit( WikimediaLexem::CloseFormat);
 					case TagBlockquoteOpen:
-						return WikimediaLexem( WikimediaLexem::OpenBlockQuote);
+						return emit( WikimediaLexem::OpenBlockQuote);
 					case TagBlockquoteClose:
-						return WikimediaLexem( WikimediaLexem::CloseBlockQuote);
+						return emit( WikimediaLexem::CloseBlockQuote);
 					case TagPoemOpen:
-						return WikimediaLexem( WikimediaLexem::OpenPoem);
+						return emit( WikimediaLexem::OpenPoem);
 					case TagPoemClose:
-						return WikimediaLexem( WikimediaLexem::ClosePoem);
+						return emit( WikimediaLexem::ClosePoem);
 					case TagCiteOpen:
-						return WikimediaLexem( WikimediaLexem::OpenRef);
+						return emit( WikimediaLexem::OpenRef);
 					case TagCiteClose:
-						return WikimediaLexem( WikimediaLexem::CloseRef);
+						return emit( WikimediaLexem::CloseRef);
 					case TagDivOpen:
-						return WikimediaLexem( WikimediaLexem::OpenDiv);
+						return emit( WikimediaLexem::OpenDiv);
 					case TagDivClose:
-						return WikimediaLexem( WikimediaLexem::CloseDiv);
+						return emit( WikimediaLexem::CloseDiv);
 					case TagComment:
 						start = m_si;
 						break;
 					case TagBr:
-						return WikimediaLexem( WikimediaLexem::Text, 0, "\n");
+						return emit( WikimediaLexem::Text, 0, "\n");
 				}
 			}
 			else
@@ -1290,7 +1346,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			char eb = *m_si;
 			m_si += 1;
@@ -1303,46 +1359,46 @@ WikimediaLexem WikimediaLexer::next()
 				m_si = xi+1;
 				if (charClassChangeCount( value.c_str(), value.c_str() + value.size()) >= 4)
 				{
-					return WikimediaLexem( WikimediaLexem::Code, 0, value);
+					return emit( WikimediaLexem::Code, 0, value);
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::String, 0, value);
+					return emit( WikimediaLexem::String, 0, value);
 				}
 			}
 			else
 			{
-				return WikimediaLexem( WikimediaLexem::QuotationMarker);
+				return emit( WikimediaLexem::QuotationMarker);
 			}
 		}
 		else if (m_si[0] == '&' && (m_se - m_si) >= 6 && compareFollowString( m_si, m_se, "&quot;"))
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			m_si += 6;
-			return WikimediaLexem( WikimediaLexem::QuotationMarker);
+			return emit( WikimediaLexem::QuotationMarker);
 		}
 		else if (m_si[0] == '&' && (m_se - m_si) >= 6 && compareFollowString( m_si, m_se, "&nbsp;"))
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			m_si += 6;
-			return WikimediaLexem( WikimediaLexem::Text, 0, " ");
+			return emit( WikimediaLexem::Text, 0, " ");
 		}
 		else if (*m_si == '#')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			if (compareFollowString( m_si, m_se, "#REDIRECT"))
 			{
 				m_si += 9;
-				return WikimediaLexem( WikimediaLexem::Redirect);
+				return emit( WikimediaLexem::Redirect);
 			}
 			else
 			{
@@ -1353,7 +1409,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			int sidx = 0;
 			if (m_si[2] == ']')
@@ -1366,21 +1422,21 @@ WikimediaLexem WikimediaLexer::next()
 					const char* tkstart = m_si+2;
 					int tksize = ci - tkstart;
 					m_si = ci + 2;
-					return WikimediaLexem( WikimediaLexem::Char, 0, std::string( tkstart, tksize));
+					return emit( WikimediaLexem::Char, 0, WikimediaLexemValue( tkstart, tksize));
 				}
 			}
 			for (; m_si < m_se && *m_si == '\''; ++sidx,++m_si){}
 			if (sidx >= 6)
 			{
-				return WikimediaLexem( WikimediaLexem::NoData, 0, std::string(start,sidx));
+				return emit( WikimediaLexem::NoData, 0, WikimediaLexemValue(start,sidx));
 			}
-			return WikimediaLexem( WikimediaLexem::MultiQuoteMarker, sidx, "");
+			return emit( WikimediaLexem::MultiQuoteMarker, sidx, "");
 		}
 		else if (*m_si == '[')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			++m_si;
 			if (m_si == m_se) break;
@@ -1401,7 +1457,7 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					const char* chptr = m_si;
 					m_si += chlen+2;
-					return WikimediaLexem( WikimediaLexem::Char, 0, std::string(chptr,chlen));
+					return emit( WikimediaLexem::Char, 0, WikimediaLexemValue(chptr,chlen));
 				}
 				if (m_si < m_se && *m_si == '#')++m_si;
 				if (m_si < m_se && *m_si == ':')++m_si;
@@ -1409,7 +1465,7 @@ WikimediaLexem WikimediaLexer::next()
 				if (isUrlCandidate( m_si, m_se))
 				{
 					linkid = tryParseURL();
-					return WikimediaLexem( WikimediaLexem::OpenWWWLink, 0, linkid);
+					return emit( WikimediaLexem::OpenWWWLink, 0, linkid);
 				}
 				else
 				{
@@ -1417,13 +1473,13 @@ WikimediaLexem WikimediaLexer::next()
 					if (!linkid.empty() && m_si < m_se && (*m_si == ']' || *m_si == '|'))
 					{
 						if (*m_si == '|') ++m_si;
-						return WikimediaLexem( WikimediaLexem::OpenPageLink, 0, linkid);
+						return emit( WikimediaLexem::OpenPageLink, 0, linkid);
 					}
 					else
 					{
 						while (m_si < m_se && *m_si != ']') ++m_si;
 						if (m_si < m_se && *m_si == ']') ++m_si;
-						return WikimediaLexem( WikimediaLexem::Error, 0, "illegal character in page link");
+						return emit( WikimediaLexem::Error, 0, "illegal character in page link");
 					}
 					
 				}
@@ -1458,13 +1514,13 @@ WikimediaLexem WikimediaLexer::next()
 				else if (m_si < m_se && (isTokenDelimiter(*m_si) || isSpace(*m_si)))
 				{
 					if (*m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::OpenWWWLink, 0, linkid);
+					return emit( WikimediaLexem::OpenWWWLink, 0, linkid);
 				}
 				else
 				{
 					while (m_si < m_se && *m_si != ']') ++m_si;
 					if (m_si < m_se && *m_si == ']') ++m_si;
-					return WikimediaLexem( WikimediaLexem::Error, 0, "illegal character in WWW link");
+					return emit( WikimediaLexem::Error, 0, "illegal character in WWW link");
 				}
 			}
 			else
@@ -1476,11 +1532,11 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					std::string value( m_si, xi-m_si);
 					m_si = ++xi;
-					return WikimediaLexem( WikimediaLexem::Char, 0, value);
+					return emit( WikimediaLexem::Char, 0, value);
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::Text, 0, " [");
+					return emit( WikimediaLexem::Text, 0, " [");
 				}
 			}
 		}
@@ -1488,7 +1544,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			++m_si;
 			if (m_si == m_se) break;
@@ -1503,7 +1559,7 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					std::string title( strus::string_conv::trim( std::string( start, m_si - start)));
 					m_si += 2;
-					return WikimediaLexem( WikimediaLexem::Markup, 0, title);
+					return emit( WikimediaLexem::Markup, 0, title);
 				}
 				m_si = start;
 				while (m_si < m_se && *m_si != '}' && *m_si != '|' && (isAlphaNum(*m_si) || *m_si == '_' || *m_si == '-' || isSpace(*m_si)))
@@ -1513,12 +1569,12 @@ WikimediaLexem WikimediaLexer::next()
 				if (m_si < m_se && (*m_si == '}' || *m_si == '|'))
 				{
 					std::string citid( strus::string_conv::trim( std::string( start, m_si - start)));
-					return WikimediaLexem( WikimediaLexem::OpenCitation, 0, citid);
+					return emit( WikimediaLexem::OpenCitation, 0, citid);
 				}
 				else
 				{
 					m_si = start;
-					return WikimediaLexem( WikimediaLexem::OpenCitation);
+					return emit( WikimediaLexem::OpenCitation);
 				}
 			}
 			else if (*m_si == '|')
@@ -1538,14 +1594,14 @@ WikimediaLexem WikimediaLexer::next()
 					if (m_si < m_se && *m_si == '|') {more=true; ++m_si;}
 					attributes.insert( aa.begin(), aa.end());
 				} while (more);
-				return WikimediaLexem( WikimediaLexem::OpenTable, 0, "", attributes);
+				return emit( WikimediaLexem::OpenTable, 0, "", attributes);
 			}
 		}
 		else if (*m_si == '|')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			++m_si;
 			if (m_si == m_se) break;
@@ -1556,37 +1612,37 @@ WikimediaLexem WikimediaLexer::next()
 				std::map<std::string,std::string> attributes;
 				parseAttributes( m_si, m_se,  '|', '\n', attributes);
 				if (m_si+2 < m_se && m_si[0] == '|' && m_si[1] != '|') ++m_si;
-				return WikimediaLexem( WikimediaLexem::DoubleColDelim, 0, "", attributes);
+				return emit( WikimediaLexem::DoubleColDelim, 0, "", attributes);
 			}
 			else
 			{
 				std::string name = tryParseIdentifier( '=');
-				return WikimediaLexem( WikimediaLexem::ColDelim, 0, name);
+				return emit( WikimediaLexem::ColDelim, 0, name);
 			}
 		}
 		else if (*m_si == '!' && m_si+1 < m_se && m_si[1] == '!')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			m_si += 2;
 			std::map<std::string,std::string> attributes;
 			parseAttributes( m_si, m_se,  '|', '\n', attributes);
 			if (m_si < m_se && *m_si == '|') ++m_si;
-			return WikimediaLexem( WikimediaLexem::TableHeadDelim, 0, "", attributes);
+			return emit( WikimediaLexem::TableHeadDelim, 0, "", attributes);
 		}
 		else if (*m_si == '\n')
 		{
 			m_curHeading = 0;
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			while (m_si < m_se && isSpace(*m_si)) ++m_si;
 			if (m_si == m_se)
 			{
-				return WikimediaLexem( WikimediaLexem::EndOfLine);
+				return emit( WikimediaLexem::EndOfLine);
 			}
 			else if (*m_si == '!')
 			{
@@ -1594,7 +1650,7 @@ WikimediaLexem WikimediaLexer::next()
 				std::map<std::string,std::string> attributes;
 				parseAttributes( m_si, m_se, '|', '\n', attributes);
 				if (m_si < m_se && *m_si == '|') ++m_si;
-				return WikimediaLexem( WikimediaLexem::TableHeadDelim, 0, "", attributes);
+				return emit( WikimediaLexem::TableHeadDelim, 0, "", attributes);
 			}
 			else if (*m_si == '|')
 			{
@@ -1609,7 +1665,7 @@ WikimediaLexem WikimediaLexer::next()
 					std::map<std::string,std::string> attributes;
 					parseAttributes( m_si, m_se,  '|', '\n', attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::TableRowDelim, 0, "", attributes);
+					return emit( WikimediaLexem::TableRowDelim, 0, "", attributes);
 				}
 				else if (*m_si == '+')
 				{
@@ -1617,7 +1673,7 @@ WikimediaLexem WikimediaLexer::next()
 					std::map<std::string,std::string> attributes;
 					parseAttributes( m_si, m_se,  '|', '\n', attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::TableTitle, 0, "", attributes);
+					return emit( WikimediaLexem::TableTitle, 0, "", attributes);
 				}
 				else if (*m_si == '!')
 				{
@@ -1625,17 +1681,17 @@ WikimediaLexem WikimediaLexer::next()
 					std::map<std::string,std::string> attributes;
 					parseAttributes( m_si, m_se, '|', '\n', attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::TableHeadDelim, 0, "", attributes);
+					return emit( WikimediaLexem::TableHeadDelim, 0, "", attributes);
 				}
 				else if (*m_si == '}')
 				{
 					++m_si;
-					return WikimediaLexem( WikimediaLexem::CloseTable);
+					return emit( WikimediaLexem::CloseTable);
 				}
 				else if (*m_si == '|')
 				{
 					++m_si;
-					return WikimediaLexem( WikimediaLexem::DoubleColDelim);
+					return emit( WikimediaLexem::DoubleColDelim);
 				}
 				else
 				{
@@ -1643,7 +1699,7 @@ WikimediaLexem WikimediaLexer::next()
 					parseAttributes( m_si, m_se, '|', '\n', attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
 					std::string name = tryParseIdentifier( '=');
-					return WikimediaLexem( WikimediaLexem::TableColDelim, 0, name, attributes);
+					return emit( WikimediaLexem::TableColDelim, 0, name, attributes);
 				}
 			}
 			else if (*m_si == '*')
@@ -1651,18 +1707,18 @@ WikimediaLexem WikimediaLexer::next()
 				int lidx = countAndSkip( m_si, m_se, '*', 18);
 				if (lidx >= 1)
 				{
-					return WikimediaLexem( WikimediaLexem::ListItem, lidx, "");
+					return emit( WikimediaLexem::ListItem, lidx, "");
 				}
 			}
 			else if (m_si+2 < m_se && m_si[0] == ':' && m_si[1] == ';')
 			{
 				m_si += 2;
-				return WikimediaLexem( WikimediaLexem::HeadingItem);
+				return emit( WikimediaLexem::HeadingItem);
 			}
 			else if (m_si+2 < m_se && m_si[0] == ':' && m_si[1] == '#')
 			{
 				m_si += 2;
-				return WikimediaLexem( WikimediaLexem::ListItem, 1, "");
+				return emit( WikimediaLexem::ListItem, 1, "");
 			}
 			else if (*m_si == '=')
 			{
@@ -1670,7 +1726,7 @@ WikimediaLexem WikimediaLexer::next()
 				if (tcnt > 1)
 				{
 					m_curHeading = tcnt;
-					return WikimediaLexem( WikimediaLexem::OpenHeading, tcnt-1, "");
+					return emit( WikimediaLexem::OpenHeading, tcnt-1, "");
 				}
 			}
 			else if (m_si+6 < m_se && (isEqual("File:",m_si,5) || isEqual("Image:",m_si,6)))
@@ -1680,36 +1736,36 @@ WikimediaLexem WikimediaLexer::next()
 				if (m_si < m_se && *m_si == '|')
 				{
 					++m_si;
-					return WikimediaLexem( WikimediaLexem::ListItem, 1, "");
+					return emit( WikimediaLexem::ListItem, 1, "");
 				}
 			}
 			else
 			{
-				return WikimediaLexem( WikimediaLexem::EndOfLine);
+				return emit( WikimediaLexem::EndOfLine);
 			}
 		}
 		else if (*m_si == '}' && m_si+1 < m_se && m_si[1] == '}')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			m_si += 2;
-			return WikimediaLexem( WikimediaLexem::CloseCitation);
+			return emit( WikimediaLexem::CloseCitation);
 		}
 		else if (*m_si == ']')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			++m_si;
 			if (m_si < m_se && *m_si == ']')
 			{
 				++m_si;
-				return WikimediaLexem( WikimediaLexem::ClosePageLink);
+				return emit( WikimediaLexem::ClosePageLink);
 			}
-			return WikimediaLexem( WikimediaLexem::CloseWWWLink, 0, "]");
+			return emit( WikimediaLexem::CloseWWWLink, 0, "]");
 		}
 		else if (m_si + 3 < m_se && m_si[0] == ':' && m_si[1] == '/' && m_si[2] == '/')
 		{
@@ -1724,7 +1780,7 @@ WikimediaLexem WikimediaLexer::next()
 					std::string url = tryParseURL();
 					if (!url.empty())
 					{
-						return WikimediaLexem( WikimediaLexem::Url, 0, url);
+						return emit( WikimediaLexem::Url, 0, url);
 					}
 					else
 					{
@@ -1735,7 +1791,7 @@ WikimediaLexem WikimediaLexer::next()
 				else
 				{
 					m_si = ti;
-					return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+					return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 				}
 			}
 			else
@@ -1748,7 +1804,7 @@ WikimediaLexem WikimediaLexer::next()
 			std::string timestmp( tryParseTimestamp());
 			if (!timestmp.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::Timestamp, 0, timestmp);
+				return emit( WikimediaLexem::Timestamp, 0, timestmp);
 			}
 			else
 			{
@@ -1759,12 +1815,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			std::string bibref = tryParseBibRef();
 			if (!bibref.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::BibRef, 0, bibref);
+				return emit( WikimediaLexem::BibRef, 0, bibref);
 			}
 			else
 			{
@@ -1775,12 +1831,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			std::string bibref = tryParseBookRef();
 			if (!bibref.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::BibRef, 0, bibref);
+				return emit( WikimediaLexem::BibRef, 0, bibref);
 			}
 			else
 			{
@@ -1791,12 +1847,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			std::string bibref = tryParseIsbnRef();
 			if (!bibref.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::BibRef, 0, bibref);
+				return emit( WikimediaLexem::BibRef, 0, bibref);
 			}
 			else
 			{
@@ -1807,12 +1863,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			std::string bighexnum = tryParseBigHexNum();
 			if (!bighexnum.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::Code, 0, bighexnum);
+				return emit( WikimediaLexem::Code, 0, bighexnum);
 			}
 			else
 			{
@@ -1823,12 +1879,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			std::string code = tryParseCode();
 			if (!code.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::Code, 0, code);
+				return emit( WikimediaLexem::Code, 0, code);
 			}
 			else
 			{
@@ -1851,11 +1907,11 @@ WikimediaLexem WikimediaLexer::next()
 				else if (ti > start)
 				{
 					m_si = ti;
-					return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, ti - start));
+					return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, ti - start));
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::Url, 0, std::string("file:") + filepath);
+					return emit( WikimediaLexem::Url, 0, std::string("file:") + filepath);
 				}
 			}
 			else
@@ -1867,14 +1923,14 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			const char* paramend = skipUrlParameters( m_si, m_se);
 			if (paramend)
 			{
 				const char* paramstart = m_si;
 				m_si = paramend;
-				return WikimediaLexem( WikimediaLexem::NoData, 0, std::string( paramstart, paramend - paramstart));
+				return emit( WikimediaLexem::NoData, 0, WikimediaLexemValue( paramstart, paramend - paramstart));
 			}
 			else
 			{
@@ -1885,12 +1941,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 			}
 			std::string ptstr = tryParseRepPattern();
 			if (!ptstr.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::NoData, 0, ptstr);
+				return emit( WikimediaLexem::NoData, 0, ptstr);
 			}
 			else
 			{
@@ -1905,16 +1961,32 @@ WikimediaLexem WikimediaLexer::next()
 	}
 	catch (const std::runtime_error& err)
 	{
-		return WikimediaLexem( WikimediaLexem::Error, 0, err.what());
+		return emit( WikimediaLexem::Error, 0, std::string( err.what()));
 	}
 	if (start != m_si)
 	{
-		return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+		return emit( WikimediaLexem::Text, 0, WikimediaLexemValue( start, m_si - start));
 	}
 	else
+	{
+		return false;
+	}
+}
+
+WikimediaLexem WikimediaLexer::next()
+{
+	if (!scan())
 	{
 		return WikimediaLexem( WikimediaLexem::EoF);
 	}
+	else if (m_lexemValueOwned)
+	{
+		return WikimediaLexem( m_lexemId, m_lexemIdx, m_valueBuffer, m_lexemAttributes);
+	}
+	else
+	{
+		return WikimediaLexem( m_lexemId, m_lexemIdx, WikimediaLexemValue( m_lexemValue, m_lexemValueSize), m_lexemAttributes);
+	}
 }
 
 std::string WikimediaLexer::currentSourceExtract( int maxlen) const
@@ -12,14 +12,67 @@
 #define _STRUS_WIKIPEDIA_WIKIMEDIA_LEXER_HPP_INCLUDED
 #include "strus/base/numstring.hpp"
 #include "strus/base/string_conv.hpp"
+#include "plainTextScan.hpp"
+#include "tagNameTable.hpp"
+#include "cpuDeadline.hpp"
 #include <string>
 #include <vector>
 #include <map>
 #include <utility>
+#include <cstring>
 
 /// \brief strus toplevel namespace
 namespace strus {
 
+/// \brief Value of a lexem, either a reference into the source of the lexer if the value appears as such in the source or a string of its own
+/// \note A reference is only valid as long as the source of the lexer, values retained have to be materialized with str()
+class WikimediaLexemValue
+{
+public:
+	WikimediaLexemValue()
+		:m_ptr(""),m_size(0),m_str(),m_owned(false){}
+	/// \brief Constructor of a reference into the source, without copying
+	WikimediaLexemValue( const char* ptr_, std::size_t size_)
+		:m_ptr(ptr_),m_size(size_),m_str(),m_owned(false){}
+	/// \brief Constructor of a value of its own
+	WikimediaLexemValue( const std::string& str_)
+		:m_ptr(0),m_size(str_.size()),m_str(str_),m_owned(true)
+	{
+		m_ptr = m_str.c_str();
+	}
+	/// \brief Constructor of a value of its own
+	WikimediaLexemValue( const char* str_)
+		:m_ptr(0),m_size(std::strlen(str_)),m_str(str_),m_owned(true)
+	{
+		m_ptr = m_str.c_str();
+	}
+	WikimediaLexemValue( const WikimediaLexemValue& o)
+		:m_ptr(o.m_ptr),m_size(o.m_size),m_str(o.m_str),m_owned(o.m_owned)
+	{
+		if (m_owned) m_ptr = m_str.c_str();
+	}
+	WikimediaLexemValue& operator=( const WikimediaLexemValue& o)
+	{
+		m_str = o.m_str;
+		m_owned = o.m_owned;
+		m_ptr = m_owned ? m_str.c_str() : o.m_ptr;
+		m_size = o.m_size;
+		return *this;
+	}
+
+	const char* data() const		{return m_ptr;}
+	std::size_t size() const		{return m_size;}
+	bool empty() const			{return m_size == 0;}
+	/// \brief Get the value as string (copy)
+	std::string str() const			{return std::string( m_ptr, m_size);}
+
+private:
+	const char* m_ptr;
+	std::size_t m_size;
+	std::string m_str;			//... value of its own, if not a reference into the source
+	bool m_owned;
+};
+
 struct WikimediaLexem
 {
 	enum Id
@@ -91,35 +144,47 @@ struct WikimediaLexem
 	}
 	typedef std::map<std::string,std::string> AttributeMap;
 
-	WikimediaLexem( Id id_, int idx_, const std::string& value_, const AttributeMap& attributes_=AttributeMap())
+	WikimediaLexem( Id id_, int idx_, const WikimediaLexemValue& value_, const AttributeMap& attributes_=AttributeMap())
 		:id(id_),idx(idx_),value(value_),attributes(attributes_){}
 	WikimediaLexem( Id id_)
 		:id(id_),idx(0),value(),attributes(){}
 	WikimediaLexem( const WikimediaLexem& o)
 		:id(o.id),idx(o.idx),value(o.value),attributes(o.attributes){}
 
-	int attributeToInt( const std::string& name_) const
+	static int attributeToInt( const AttributeMap& attributes_, const std::string& name_)
 	{
 		std::string name( string_conv::tolower( name_));
-		AttributeMap::const_iterator ai = attributes.find( name);
-		if (ai == attributes.end()) return 1;
+		AttributeMap::const_iterator ai = attributes_.find( name);
+		if (ai == attributes_.end()) return 1;
 		strus::NumParseError err = NumParseOk;
 		int rt = strus::uintFromString( ai->second, 1<<15, err);
 		return (err == NumParseOk) ? rt:-1;
 	}
+	static int colspan( const AttributeMap& attributes_)
+	{
+		return attributeToInt( attributes_, "colspan");
+	}
+	static int rowspan( const AttributeMap& attributes_)
+	{
+		return attributeToInt( attributes_, "rowspan");
+	}
 
+	int attributeToInt( const std::string& name_) const
+	{
+		return attributeToInt( attributes, name_);
+	}
 	int colspan() const
 	{
-		return attributeToInt( "colspan");
+		return colspan( attributes);
 	}
 	int rowspan() const
 	{
-		return attributeToInt( "rowspan");
+		return rowspan( attributes);
 	}
 
 	Id id;
 	int idx;
-	std::string value;
+	WikimediaLexemValue value;
 	AttributeMap attributes;
 };
 
@@ -127,9 +192,38 @@ class WikimediaLexer
 {
 public:
 
-	WikimediaLexer( const char* src, std::size_t size)
-		:m_prev_si(src),m_si(src),m_se(src+size),m_curHeading(0){}
+	/// \brief Constructor
+	/// \param[in] src source to scan
+	/// \param[in] size size of the source in bytes
+	/// \param[in] stopMaskFunc_ function used to skip plain text, NULL for looking at every byte
+	WikimediaLexer( const char* src, std::size_t size, PlainTextStopMaskFunction stopMaskFunc_=plainTextStopMaskDefault)
+		:m_prev_si(src),m_si(src),m_se(src+size),m_curHeading(0)
+		,m_stopMaskFunc(stopMaskFunc_),m_stopBase(0),m_stopMask(0)
+		,m_lexemId(WikimediaLexem::EoF),m_lexemIdx(0),m_lexemValue(""),m_lexemValueSize(0),m_lexemValueOwned(false)
+		,m_valueBuffer(),m_lexemAttributes(),m_deadline(0){}
 
+	/// \brief Set the CPU time limit polled in the scan loop
+	/// \param[in] deadline_ deadline (with ownership kept by the caller) or NULL for no limit
+	void setDeadline( CpuDeadline* deadline_)
+	{
+		m_deadline = deadline_;
+	}
+
+	/// \brief Scan the whole source calling a handler for each lexem, without creating lexem objects
+	/// \param[in,out] handler object with a method
+	///	void lexem( WikimediaLexem::Id id, int idx, const char* value, std::size_t valuesize, const WikimediaLexem::AttributeMap& attributes)
+	///	called for each lexem except EoF, the arguments are only valid during the call.
+	///	Exceptions thrown by the handler are passed to the caller.
+	template <class HANDLER>
+	void parse( HANDLER& handler)
+	{
+		while (scan())
+		{
+			handler.lexem( m_lexemId, m_lexemIdx, m_lexemValue, m_lexemValueSize, m_lexemAttributes);
+		}
+	}
+
+	/// \brief Get the next lexem as object (pull interface on top of the interface with a handler, see parse)
 	WikimediaLexem next();
 	std::string rest() const;
 	std::string currentSourceExtract( int maxlen) const;
@@ -149,14 +243,76 @@ private:
 	std::string tryParseRepPattern();
 	std::string tryParseCode();
 	bool eatFollowChar( char expectChr);
+	void skipPlainText();
+	bool scan();
+
+	//... set the current lexem, return true as result of scan
+	bool emit( WikimediaLexem::Id id_)
+	{
+		return emit( id_, 0, "");
+	}
+	/// \param[in] value_ string constant
+	bool emit( WikimediaLexem::Id id_, int idx_, const char* value_)
+	{
+		setLexem( id_, idx_, value_, std::strlen( value_), false);
+		return true;
+	}
+	/// \param[in] value_ reference into the source
+	bool emit( WikimediaLexem::Id id_, int idx_, const WikimediaLexemValue& value_)
+	{
+		setLexem( id_, idx_, value_.data(), value_.size(), false);
+		return true;
+	}
+	bool emit( WikimediaLexem::Id id_, int idx_, const std::string& value_)
+	{
+		m_valueBuffer = value_;
+		setLexem( id_, idx_, m_valueBuffer.c_str(), m_valueBuffer.size(), true);
+		return true;
+	}
+	/// \param[in,out] attributes_ attributes of the lexem, moved to the lexem by swapping
+	bool emit( WikimediaLexem::Id id_, int idx_, const char* value_, WikimediaLexem::AttributeMap& attributes_)
+	{
+		emit( id_, idx_, value_);
+		m_lexemAttributes.swap( attributes_);
+		return true;
+	}
+	bool emit( WikimediaLexem::Id id_, int idx_, const std::string& value_, WikimediaLexem::AttributeMap& attributes_)
+	{
+		emit( id_, idx_, value_);
+		m_lexemAttributes.swap( attributes_);
+		return true;
+	}
+	void setLexem( WikimediaLexem::Id id_, int idx_, const char* value_, std::size_t valuesize_, bool owned_)
+	{
+		m_lexemId = id_;
+		m_lexemIdx = idx_;
+		m_lexemValue = value_;
+		m_lexemValueSize = valuesize_;
+		m_lexemValueOwned = owned_;
+		if (!m_lexemAttributes.empty()) m_lexemAttributes.clear();
+	}
 
 private:
 	char const* m_prev_si;
 	char const* m_si;
 	const char* m_se;
 	int m_curHeading;
+	PlainTextStopMaskFunction m_stopMaskFunc;
+	const char* m_stopBase;			//... start of the positions covered by m_stopMask
+	unsigned int m_stopMask;		//... positions starting from m_stopBase the lexer has to look at
+	WikimediaLexem::Id m_lexemId;		//... current lexem scanned
+	int m_lexemIdx;
+	const char* m_lexemValue;
+	std::size_t m_lexemValueSize;
+	bool m_lexemValueOwned;			//... value is in m_valueBuffer and not a reference into the source or a constant
+	std::string m_valueBuffer;
+	WikimediaLexem::AttributeMap m_lexemAttributes;
+	CpuDeadline* m_deadline;		//... CPU time limit polled in the scan loop or NULL
 };
 
+/// \brief Table of the names of the tags recognized by the lexer, the index of a name is the index of its definition in the lexer
+const TagNameTable& wikimediaTagNameTable();
+
 }//namespace
 #endif
 
@@ -0,0 +1,31 @@
+# Test resuming an interrupted conversion from a checkpoint (options --checkpoint, --resume)
+# Usage: cmake -DTESTBIN=<program> -DINPUT=<inputfile> -DWORKDIR=<dir> -DOPTIONS=<options> -P checkpointResume.cmake
+#	The interrupted run is simulated with a run on the first part of the input, cut at a page start.
+#	The output of the resumed run has to be equal to the output of a run on the whole input.
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+run_converter_clean( ${WORKDIR}/expected "${OPTIONS}" ${INPUT})
+
+file( READ ${INPUT} HEAD LIMIT 1024)
+string( REGEX MATCH "<([A-Za-z]+)" ROOTTAG "${HEAD}")
+set( ROOTTAG ${CMAKE_MATCH_1})
+file( READ ${INPUT} MIDDLE OFFSET 200000 LIMIT 65536)
+string( FIND "${MIDDLE}" "<page>" PAGEPOS)
+if (PAGEPOS LESS 0)
+	message( FATAL_ERROR "input ${INPUT} too small for the test" )
+endif()
+math( EXPR CUTPOS "200000 + ${PAGEPOS}" )
+file( READ ${INPUT} PART LIMIT ${CUTPOS})
+file( WRITE ${WORKDIR}/part.xml "${PART}</${ROOTTAG}>\n")
+
+set( CHECKPOINT ${WORKDIR}/checkpoint.txt )
+file( REMOVE ${CHECKPOINT})
+run_converter_clean( ${WORKDIR}/result "${OPTIONS} --checkpoint ${CHECKPOINT} --checkpointinterval 5" ${WORKDIR}/part.xml)
+if (NOT EXISTS ${CHECKPOINT})
+	message( FATAL_ERROR "no checkpoint written to ${CHECKPOINT}" )
+endif()
+run_converter( ${WORKDIR}/result "${OPTIONS} --checkpoint ${CHECKPOINT} --resume" ${INPUT})
+if (NOT CONVERTER_ERRORS MATCHES "resuming conversion at document [1-9]")
+	message( FATAL_ERROR "conversion not resumed from the checkpoint:\n${CONVERTER_ERRORS}" )
+endif()
+compare_output_dirs( ${WORKDIR}/expected ${WORKDIR}/result)
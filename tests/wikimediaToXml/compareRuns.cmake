@@ -0,0 +1,9 @@
+# Test running strusWikimediaToXml with two sets of options on the same input and comparing the output files
+# Usage: cmake -DTESTBIN=<program> -DINPUT=<inputfile> -DWORKDIR=<dir> -DOPTIONS_EXPECTED=<options> -DOPTIONS=<options> -P compareRuns.cmake
+#	OPTIONS_EXPECTED	options of the run producing the expected output (e.g. a plain single threaded run)
+#	OPTIONS			options of the run tested
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+run_converter_clean( ${WORKDIR}/expected "${OPTIONS_EXPECTED}" ${INPUT})
+run_converter_clean( ${WORKDIR}/result "${OPTIONS}" ${INPUT})
+compare_output_dirs( ${WORKDIR}/expected ${WORKDIR}/result)
@@ -0,0 +1,40 @@
+# Test aborting the conversion of a document exceeding a CPU time limit (option --cpulimit)
+# Usage: cmake -DTESTBIN=<program> -DWORKDIR=<dir> -DOPTIONS=<options> -P cpuLimit.cmake
+#	Converts a generated dump with a small page and a big page with a CPU time limit of 1 ms.
+#	The big page has to be aborted with its error written to its .ftl file, the small page has to be converted.
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+set( TEXT "A ''quoted'' text with a [[Page link|link]], a {{cite web|url=http://example.org|title=citation}} and a reference&lt;ref&gt;Reference&lt;/ref&gt;.\n" )
+foreach (IDX RANGE 13)
+	set( TEXT "${TEXT}${TEXT}" )
+endforeach()
+set( PAGEHEAD "  <page>\n    <title>TITLE</title>\n    <ns>0</ns>\n    <id>ID</id>\n    <revision>\n      <id>ID</id>\n      <text xml:space=\"preserve\">" )
+set( PAGETAIL "</text>\n    </revision>\n  </page>\n" )
+string( REPLACE "TITLE" "Small page" SMALLHEAD "${PAGEHEAD}")
+string( REPLACE "ID" "1" SMALLHEAD "${SMALLHEAD}")
+string( REPLACE "TITLE" "Big page" BIGHEAD "${PAGEHEAD}")
+string( REPLACE "ID" "2" BIGHEAD "${BIGHEAD}")
+file( MAKE_DIRECTORY ${WORKDIR})
+file( WRITE ${WORKDIR}/bigpage.xml "<wikimedia>\n${SMALLHEAD}A small page.${PAGETAIL}${BIGHEAD}${TEXT}${PAGETAIL}</wikimedia>\n")
+
+run_converter_clean( ${WORKDIR}/output "${OPTIONS} --cpulimit 1" ${WORKDIR}/bigpage.xml)
+if (NOT CONVERTER_ERRORS MATCHES "1 documents aborted after exceeding the CPU time limit of 1 ms")
+	message( FATAL_ERROR "aborted document not reported:\n${CONVERTER_ERRORS}" )
+endif()
+if (NOT CONVERTER_ERRORS MATCHES "Big page")
+	message( FATAL_ERROR "big page not listed as aborted:\n${CONVERTER_ERRORS}" )
+endif()
+file( GLOB_RECURSE FTLFILES ${WORKDIR}/output/*.ftl)
+list( LENGTH FTLFILES NOF_FTLFILES)
+if (NOT NOF_FTLFILES EQUAL 1 OR NOT FTLFILES MATCHES "Big_page[.]ftl$")
+	message( FATAL_ERROR "expected only the .ftl file of the big page: ${FTLFILES}" )
+endif()
+file( READ ${FTLFILES} FTL)
+if (NOT FTL MATCHES "CPU time limit of 1 ms")
+	message( FATAL_ERROR "unexpected content of ${FTLFILES}: ${FTL}" )
+endif()
+file( GLOB_RECURSE SMALLFILES ${WORKDIR}/output/*/Small_page.xml)
+if (NOT SMALLFILES)
+	message( FATAL_ERROR "small page not converted" )
+endif()
+message( "big page aborted, small page converted" )
@@ -0,0 +1,99 @@
+# Test the incremental conversion of a modified dump (options --manifest, --incremental)
+# Usage: cmake -DTESTBIN=<program> -DINPUT=<inputfile> -DWORKDIR=<dir> -DOPTIONS=<options> -DCHANGED=<title> -DDELETED=<title> -P incremental.cmake
+#	The modified dump is the input with the revision of the page CHANGED changed, the page DELETED removed and a new page added.
+#	The incremental run writes into an empty directory, so the files written by it are exactly the documents converted again.
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+set( NEWPAGE "Incremental test page" )
+set( MANIFEST1 ${WORKDIR}/manifest1.txt )
+set( MANIFEST2 ${WORKDIR}/manifest2.txt )
+file( REMOVE ${MANIFEST1} ${MANIFEST2})
+
+# Find the position of the page with a title in the dump, fail if it does not exist
+function( find_page RESULT CONTENT TITLE)
+	string( FIND "${CONTENT}" "<title>${TITLE}</title>" POS)
+	if (POS LESS 0)
+		message( FATAL_ERROR "page '${TITLE}' not found in ${INPUT}" )
+	endif()
+	set( ${RESULT} ${POS} PARENT_SCOPE )
+endfunction()
+
+# Replace the first occurrence of a pattern after a position in a string
+function( replace_after VAR POS PATTERN REPLACEMENT)
+	string( SUBSTRING "${${VAR}}" 0 ${POS} HEAD)
+	string( SUBSTRING "${${VAR}}" ${POS} -1 TAIL)
+	string( FIND "${TAIL}" "${PATTERN}" IDX)
+	if (IDX LESS 0)
+		message( FATAL_ERROR "'${PATTERN}' not found" )
+	endif()
+	string( LENGTH "${PATTERN}" LEN)
+	string( SUBSTRING "${TAIL}" 0 ${IDX} BEFORE)
+	math( EXPR IDX "${IDX} + ${LEN}" )
+	string( SUBSTRING "${TAIL}" ${IDX} -1 AFTER)
+	set( ${VAR} "${HEAD}${BEFORE}${REPLACEMENT}${AFTER}" PARENT_SCOPE )
+endfunction()
+
+# Build the modified dump:
+file( READ ${INPUT} CONTENT)
+find_page( POS "${CONTENT}" "${CHANGED}")
+replace_after( CONTENT ${POS} "<sha1>" "<sha1>changed")
+replace_after( CONTENT ${POS} "<text xml:space=\"preserve\">" "<text xml:space=\"preserve\">This revision was changed by the test. ")
+
+find_page( POS "${CONTENT}" "${DELETED}")
+string( SUBSTRING "${CONTENT}" 0 ${POS} HEAD)
+string( FIND "${HEAD}" "<page>" START REVERSE)
+string( SUBSTRING "${CONTENT}" ${POS} -1 TAIL)
+string( FIND "${TAIL}" "</page>" END)
+math( EXPR END "${POS} + ${END} + 7" )
+string( SUBSTRING "${CONTENT}" 0 ${START} HEAD)
+string( SUBSTRING "${CONTENT}" ${END} -1 TAIL)
+set( CONTENT "${HEAD}${TAIL}" )
+
+string( FIND "${CONTENT}" "</page>" END REVERSE)
+math( EXPR END "${END} + 7" )
+string( SUBSTRING "${CONTENT}" 0 ${END} HEAD)
+string( SUBSTRING "${CONTENT}" ${END} -1 TAIL)
+set( PAGE "\n  <page>\n    <title>${NEWPAGE}</title>\n    <ns>0</ns>\n    <id>999999999</id>\n    <revision>\n      <id>999999999</id>\n      <text xml:space=\"preserve\">A page added to the dump for testing the incremental conversion. It has a [[link]] and a second sentence.</text>\n      <sha1>incrementaltestpage</sha1>\n    </revision>\n  </page>" )
+file( WRITE ${WORKDIR}/modified.xml "${HEAD}${PAGE}${TAIL}")
+
+# Full run on the original dump and incremental run on the modified dump:
+run_converter_clean( ${WORKDIR}/full "${OPTIONS} --manifest ${MANIFEST1}" ${INPUT})
+run_converter_clean( ${WORKDIR}/incremental "${OPTIONS} --manifest ${MANIFEST2} --incremental ${MANIFEST1}" ${WORKDIR}/modified.xml)
+
+# Only the changed and the new document are written by the incremental run:
+list_output_files( FILES ${WORKDIR}/incremental)
+string( REPLACE " " "_" CHANGED_FILE "${CHANGED}")
+string( REPLACE " " "_" NEWPAGE_FILE "${NEWPAGE}")
+set( NOF_CHANGED 0 )
+set( NOF_NEW 0 )
+foreach (FILE ${FILES})
+	get_filename_component( NAME ${FILE} NAME_WE)
+	if ("${NAME}" STREQUAL "${CHANGED_FILE}")
+		math( EXPR NOF_CHANGED "${NOF_CHANGED} + 1" )
+	elseif ("${NAME}" STREQUAL "${NEWPAGE_FILE}")
+		math( EXPR NOF_NEW "${NOF_NEW} + 1" )
+	else()
+		message( FATAL_ERROR "unexpected file ${FILE} written by the incremental run" )
+	endif()
+endforeach()
+if (NOF_CHANGED EQUAL 0 OR NOF_NEW EQUAL 0)
+	message( FATAL_ERROR "output of the changed or the new document missing, files written: ${FILES}" )
+endif()
+
+# The new manifest lists the changed, new and deleted documents:
+file( READ ${MANIFEST1} MANIFEST)
+string( REGEX MATCHALL "\n" LINES1 "${MANIFEST}")
+list( LENGTH LINES1 NOF_DOCUMENTS)
+math( EXPR NOF_UNCHANGED "${NOF_DOCUMENTS} - 2" )
+set( SUMMARY "manifest: 1 new, 1 changed, ${NOF_UNCHANGED} unchanged, 1 deleted documents" )
+if (NOT CONVERTER_ERRORS MATCHES "${SUMMARY}")
+	message( FATAL_ERROR "expected summary '${SUMMARY}' of the incremental run:\n${CONVERTER_ERRORS}" )
+endif()
+file( READ ${MANIFEST2} MANIFEST)
+foreach (ENTRY "changed\t${CHANGED}\t" "new\t${NEWPAGE}\t" "deleted\t${DELETED}\t")
+	string( FIND "\n${MANIFEST}" "\n${ENTRY}" IDX)
+	if (IDX LESS 0)
+		message( FATAL_ERROR "entry '${ENTRY}' missing in the manifest ${MANIFEST2}" )
+	endif()
+endforeach()
+message( "incremental run wrote ${NOF_CHANGED} files of the changed and ${NOF_NEW} of the new document" )
@@ -0,0 +1,94 @@
+# Test the numbering of documents by page id and by title hash (option --numbering)
+# Usage: cmake -DTESTBIN=<program> -DINPUT=<inputfile> -DCOLLISIONS=<inputfile> -DWORKDIR=<dir> -DOPTIONS=<options> -P numbering.cmake
+#	INPUT		dump converted with each numbering, the output files have to be equal to the ones numbered by order, apart from their directory
+#	COLLISIONS	dump with two pages with long titles with colliding title hashes and a page without page id
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+# Get the sorted list of the names of the files in a directory without their subdirectory
+function( list_output_names RESULT DIR)
+	list_output_files( FILES ${DIR})
+	set( NAMES "" )
+	foreach (FILE ${FILES})
+		get_filename_component( NAME ${FILE} NAME)
+		list( APPEND NAMES ${NAME})
+	endforeach()
+	list( SORT NAMES)
+	set( ${RESULT} "${NAMES}" PARENT_SCOPE )
+endfunction()
+
+# Compare the output files of a run numbered by order with the files of a run with another numbering by their names
+function( compare_output_names EXPECTED_DIR RESULT_DIR)
+	list_output_names( EXPECTED_NAMES ${EXPECTED_DIR})
+	list_output_names( RESULT_NAMES ${RESULT_DIR})
+	if (NOT "${EXPECTED_NAMES}" STREQUAL "${RESULT_NAMES}")
+		message( FATAL_ERROR "names of files in ${RESULT_DIR} differ from ${EXPECTED_DIR}" )
+	endif()
+	list_output_files( FILES ${RESULT_DIR})
+	foreach (FILE ${FILES})
+		get_filename_component( NAME ${FILE} NAME)
+		file( GLOB_RECURSE EXPECTED_FILE ${EXPECTED_DIR}/*/${NAME})
+		execute_process(
+			COMMAND ${CMAKE_COMMAND} -E compare_files ${EXPECTED_FILE} ${RESULT_DIR}/${FILE}
+			RESULT_VARIABLE RES )
+		if (NOT RES EQUAL 0)
+			message( FATAL_ERROR "content of ${RESULT_DIR}/${FILE} differs from ${EXPECTED_FILE}" )
+		endif()
+	endforeach()
+	list( LENGTH FILES NOF_FILES)
+	message( "${NOF_FILES} files in ${RESULT_DIR} equal to ${EXPECTED_DIR}" )
+endfunction()
+
+run_converter_clean( ${WORKDIR}/order "${OPTIONS}" ${INPUT})
+foreach (MODE pageid titlehash)
+	run_converter_clean( ${WORKDIR}/${MODE} "${OPTIONS} --numbering ${MODE}" ${INPUT})
+	compare_output_names( ${WORKDIR}/order ${WORKDIR}/${MODE})
+endforeach()
+
+# Documents with colliding title hashes get the same number, the names of files of long titles differ by the full title hash:
+run_converter_clean( ${WORKDIR}/collisions "${OPTIONS} --numbering titlehash" ${COLLISIONS})
+list_output_files( FILES ${WORKDIR}/collisions)
+list( LENGTH FILES NOF_FILES)
+if (NOT NOF_FILES EQUAL 3)
+	message( FATAL_ERROR "expected 3 files written with colliding title hashes: ${FILES}" )
+endif()
+set( LONGTITLE_FILES "" )
+foreach (FILE ${FILES})
+	if (FILE MATCHES "^([0-9]+)/A_very_long_title.*__[0-9a-f]+[.]xml$")
+		list( APPEND LONGTITLE_FILES ${FILE})
+		list( APPEND LONGTITLE_DIRS ${CMAKE_MATCH_1})
+	endif()
+endforeach()
+list( LENGTH LONGTITLE_FILES NOF_LONGTITLE_FILES)
+list( REMOVE_DUPLICATES LONGTITLE_DIRS)
+list( LENGTH LONGTITLE_DIRS NOF_LONGTITLE_DIRS)
+if (NOT NOF_LONGTITLE_FILES EQUAL 2 OR NOT NOF_LONGTITLE_DIRS EQUAL 1)
+	message( FATAL_ERROR "expected 2 files of long titles with colliding hashes in the same directory: ${FILES}" )
+endif()
+
+# The file of a document numbered by title hash does not depend on the part of the dump converted:
+file( READ ${COLLISIONS} CONTENT)
+string( FIND "${CONTENT}" "<page>" START)
+string( FIND "${CONTENT}" "</page>" END)
+math( EXPR END "${END} + 7" )
+string( SUBSTRING "${CONTENT}" 0 ${START} HEAD)
+string( SUBSTRING "${CONTENT}" ${END} -1 TAIL)
+file( WRITE ${WORKDIR}/part.xml "${HEAD}${TAIL}")
+run_converter_clean( ${WORKDIR}/part "${OPTIONS} --numbering titlehash" ${WORKDIR}/part.xml)
+list_output_files( PART_FILES ${WORKDIR}/part)
+foreach (FILE ${PART_FILES})
+	list( FIND FILES ${FILE} IDX)
+	if (IDX LESS 0)
+		message( FATAL_ERROR "file ${FILE} of a part of the dump not written by the conversion of the whole dump: ${FILES}" )
+	endif()
+endforeach()
+
+# Pages without page id are skipped and reported when numbered by page id:
+run_converter_clean( ${WORKDIR}/missingid "${OPTIONS} --numbering pageid" ${COLLISIONS})
+if (NOT CONVERTER_ERRORS MATCHES "1 documents skipped because of a missing or invalid page id")
+	message( FATAL_ERROR "page without page id not reported:\n${CONVERTER_ERRORS}" )
+endif()
+list_output_names( NAMES ${WORKDIR}/missingid)
+list( LENGTH NAMES NOF_FILES)
+if (NOT NOF_FILES EQUAL 2)
+	message( FATAL_ERROR "expected 2 files written of pages with page id: ${NAMES}" )
+endif()
@@ -0,0 +1,47 @@
+# Test the numbering of documents with sharded scanning (option --shards) on a dump with more than 1000 documents and with long titles
+# Usage: cmake -DTESTBIN=<program> -DWORKDIR=<dir> -DOPTIONS=<options> -DSHARDS=<n> -P shardNumbering.cmake
+#	The numbers of the documents determine the output directory (number/1000) and the suffix of names of documents with long titles.
+#	They differ from a run without option --shards, but have to be the same in every run with the same number of shards.
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+set( NOF_PAGES 2500 )
+set( LONGTITLE "A long title of a page for testing the numbering of documents with sharded scanning of the dump, exceeding the maximum file name length" )
+
+# Generate the dump, every 100th page has a long title:
+set( CONTENT "<mediawiki>\n" )
+foreach (PAGENO RANGE 1 ${NOF_PAGES})
+	math( EXPR MOD "${PAGENO} % 100" )
+	if (MOD EQUAL 0)
+		set( TITLE "${LONGTITLE} ${PAGENO}" )
+	else()
+		set( TITLE "Page ${PAGENO}" )
+	endif()
+	set( CONTENT "${CONTENT}  <page>\n    <title>${TITLE}</title>\n    <ns>0</ns>\n    <id>${PAGENO}</id>\n    <revision>\n      <id>${PAGENO}</id>\n      <text xml:space=\"preserve\">Page number ${PAGENO} with a [[link]].</text>\n    </revision>\n  </page>\n" )
+endforeach()
+set( CONTENT "${CONTENT}</mediawiki>\n" )
+file( WRITE ${WORKDIR}/input.xml "${CONTENT}")
+
+# Two sharded runs write the same files into the same directories:
+run_converter_clean( ${WORKDIR}/run1 "${OPTIONS} --shards ${SHARDS}" ${WORKDIR}/input.xml)
+run_converter_clean( ${WORKDIR}/run2 "${OPTIONS} --shards ${SHARDS}" ${WORKDIR}/input.xml)
+compare_output_dirs( ${WORKDIR}/run1 ${WORKDIR}/run2)
+
+# All documents are written into more than one directory, long titles with their number as suffix:
+list_output_files( FILES ${WORKDIR}/run1)
+set( DIRS "" )
+set( NOF_LONGTITLES 0 )
+foreach (FILE ${FILES})
+	if (FILE MATCHES "^([0-9]+)/")
+		list( APPEND DIRS ${CMAKE_MATCH_1})
+	endif()
+	if (FILE MATCHES "/A_long_title.*__[0-9]+[.]xml$")
+		math( EXPR NOF_LONGTITLES "${NOF_LONGTITLES} + 1" )
+	endif()
+endforeach()
+list( REMOVE_DUPLICATES DIRS)
+list( LENGTH DIRS NOF_DIRS)
+list( LENGTH FILES NOF_FILES)
+math( EXPR NOF_EXPECTED_LONGTITLES "${NOF_PAGES} / 100" )
+if (NOT NOF_FILES EQUAL ${NOF_PAGES} OR NOF_DIRS LESS 3 OR NOT NOF_LONGTITLES EQUAL ${NOF_EXPECTED_LONGTITLES})
+	message( FATAL_ERROR "expected ${NOF_PAGES} files in 3 directories with ${NOF_EXPECTED_LONGTITLES} long titles, got ${NOF_FILES} files in ${NOF_DIRS} directories with ${NOF_LONGTITLES} long titles" )
+endif()
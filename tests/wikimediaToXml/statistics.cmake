@@ -0,0 +1,59 @@
+# Test the report of the time spent and the amounts processed per thread (options --stats, --statsinterval)
+# Usage: cmake -DTESTBIN=<program> -DINPUT=<inputfile> -DWORKDIR=<dir> -DOPTIONS=<options> -P statistics.cmake
+#	The report has to be valid JSON, the sums of pages and documents of the threads have to be equal to the totals,
+#	the total of pages has to be the number of pages of the input and the total of documents the number of documents converted.
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+set( STATSFILE ${WORKDIR}/stats.json )
+file( REMOVE ${STATSFILE})
+run_converter_clean( ${WORKDIR}/output "${OPTIONS} --stats ${STATSFILE} --statsinterval 1" ${INPUT})
+if (NOT EXISTS ${STATSFILE})
+	message( FATAL_ERROR "no statistics written to ${STATSFILE}" )
+endif()
+file( READ ${STATSFILE} STATS)
+if (NOT CMAKE_VERSION VERSION_LESS 3.19)
+	string( JSON NOF_THREADS ERROR_VARIABLE JSON_ERROR LENGTH "${STATS}" threads)
+	if (JSON_ERROR)
+		message( FATAL_ERROR "statistics are not valid JSON: ${JSON_ERROR}\n${STATS}" )
+	endif()
+endif()
+if (NOT STATS MATCHES "^{\n\"elapsed_ns\": [0-9]+,\n\"threads\": \\[\n.*\n\\],\n\"total\": {.*}\n}\n$")
+	message( FATAL_ERROR "unexpected structure of the statistics:\n${STATS}" )
+endif()
+
+# Sum up the counters of the threads:
+string( REGEX MATCHALL "{\"thread\": \"[a-z]+ [0-9]+\", \"pages\": [0-9]+, \"documents\": [0-9]+" THREADS "${STATS}")
+set( SUM_PAGES 0 )
+set( SUM_DOCUMENTS 0 )
+foreach (THREAD ${THREADS})
+	string( REGEX MATCH "\"pages\": ([0-9]+), \"documents\": ([0-9]+)" COUNTERS "${THREAD}")
+	math( EXPR SUM_PAGES "${SUM_PAGES} + ${CMAKE_MATCH_1}" )
+	math( EXPR SUM_DOCUMENTS "${SUM_DOCUMENTS} + ${CMAKE_MATCH_2}" )
+endforeach()
+if (NOT STATS MATCHES "\"total\": {\"pages\": ([0-9]+), \"documents\": ([0-9]+),")
+	message( FATAL_ERROR "totals missing in the statistics:\n${STATS}" )
+endif()
+set( TOTAL_PAGES ${CMAKE_MATCH_1} )
+set( TOTAL_DOCUMENTS ${CMAKE_MATCH_2} )
+if (NOT SUM_PAGES EQUAL TOTAL_PAGES OR NOT SUM_DOCUMENTS EQUAL TOTAL_DOCUMENTS)
+	message( FATAL_ERROR "sums of the threads (${SUM_PAGES} pages, ${SUM_DOCUMENTS} documents) not equal to the totals (${TOTAL_PAGES} pages, ${TOTAL_DOCUMENTS} documents)" )
+endif()
+foreach (STAGE scan lex build finish toxml report write)
+	if (NOT STATS MATCHES "\"total\": {.*\"${STAGE}\": [0-9]+")
+		message( FATAL_ERROR "stage ${STAGE} missing in the totals of the statistics" )
+	endif()
+endforeach()
+
+# Compare the totals with the input and the output of the run:
+file( READ ${INPUT} CONTENT)
+string( REGEX MATCHALL "<page>" PAGES "${CONTENT}")
+list( LENGTH PAGES NOF_PAGES)
+file( GLOB_RECURSE DOCUMENTS ${WORKDIR}/output/*.xml)
+list( LENGTH DOCUMENTS NOF_DOCUMENTS)
+if (NOT TOTAL_PAGES EQUAL NOF_PAGES)
+	message( FATAL_ERROR "${TOTAL_PAGES} pages counted, input has ${NOF_PAGES}" )
+endif()
+if (NOT TOTAL_DOCUMENTS EQUAL NOF_DOCUMENTS)
+	message( FATAL_ERROR "${TOTAL_DOCUMENTS} documents counted, ${NOF_DOCUMENTS} converted" )
+endif()
+message( "statistics with ${TOTAL_PAGES} pages and ${TOTAL_DOCUMENTS} documents valid" )
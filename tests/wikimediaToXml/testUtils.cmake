@@ -0,0 +1,66 @@
+# Helper functions of the test scripts of strusWikimediaToXml running the converter and comparing its output files
+# Expects the variable TESTBIN set to the path of the program strusWikimediaToXml
+
+# Run the converter with options (string with arguments separated by spaces) on an input file writing to an output directory
+# Sets the variables CONVERTER_OUTPUT and CONVERTER_ERRORS to the output of the converter to stdout and stderr
+function( run_converter OUTDIR OPTIONS INPUT)
+	file( MAKE_DIRECTORY ${OUTDIR})
+	separate_arguments( OPTLIST UNIX_COMMAND "${OPTIONS}")
+	execute_process(
+		COMMAND ${TESTBIN} ${OPTLIST} ${INPUT} ${OUTDIR}
+		RESULT_VARIABLE RES OUTPUT_VARIABLE OUT ERROR_VARIABLE ERR )
+	if (NOT RES EQUAL 0)
+		message( FATAL_ERROR "converter failed (${RES}) with options '${OPTIONS}':\n${ERR}" )
+	endif()
+	set( CONVERTER_OUTPUT "${OUT}" PARENT_SCOPE )
+	set( CONVERTER_ERRORS "${ERR}" PARENT_SCOPE )
+endfunction()
+
+# Run the converter into a new empty output directory
+function( run_converter_clean OUTDIR OPTIONS INPUT)
+	file( REMOVE_RECURSE ${OUTDIR})
+	run_converter( ${OUTDIR} "${OPTIONS}" ${INPUT})
+	set( CONVERTER_OUTPUT "${CONVERTER_OUTPUT}" PARENT_SCOPE )
+	set( CONVERTER_ERRORS "${CONVERTER_ERRORS}" PARENT_SCOPE )
+endfunction()
+
+# Get the sorted list of files in a directory with their paths relative to it
+function( list_output_files RESULT DIR)
+	file( GLOB_RECURSE FILES RELATIVE ${DIR} ${DIR}/*)
+	list( SORT FILES)
+	set( ${RESULT} "${FILES}" PARENT_SCOPE )
+endfunction()
+
+# Compare two output directories, fail if the sets of files or the contents of any file differ
+function( compare_output_dirs EXPECTED_DIR RESULT_DIR)
+	list_output_files( EXPECTED_FILES ${EXPECTED_DIR})
+	list_output_files( RESULT_FILES ${RESULT_DIR})
+	if (NOT "${EXPECTED_FILES}" STREQUAL "${RESULT_FILES}")
+		foreach (FILE ${EXPECTED_FILES})
+			list( FIND RESULT_FILES ${FILE} IDX)
+			if (IDX LESS 0)
+				message( "missing file ${FILE} in ${RESULT_DIR}" )
+			endif()
+		endforeach()
+		foreach (FILE ${RESULT_FILES})
+			list( FIND EXPECTED_FILES ${FILE} IDX)
+			if (IDX LESS 0)
+				message( "unexpected file ${FILE} in ${RESULT_DIR}" )
+			endif()
+		endforeach()
+		message( FATAL_ERROR "files in ${RESULT_DIR} differ from ${EXPECTED_DIR}" )
+	endif()
+	list( LENGTH EXPECTED_FILES NOF_FILES)
+	if (NOF_FILES EQUAL 0)
+		message( FATAL_ERROR "no output files in ${EXPECTED_DIR}" )
+	endif()
+	foreach (FILE ${EXPECTED_FILES})
+		execute_process(
+			COMMAND ${CMAKE_COMMAND} -E compare_files ${EXPECTED_DIR}/${FILE} ${RESULT_DIR}/${FILE}
+			RESULT_VARIABLE RES )
+		if (NOT RES EQUAL 0)
+			message( FATAL_ERROR "content of ${RESULT_DIR}/${FILE} differs from ${EXPECTED_DIR}/${FILE}" )
+		endif()
+	endforeach()
+	message( "${NOF_FILES} files in ${RESULT_DIR} equal to ${EXPECTED_DIR}" )
+endfunction()
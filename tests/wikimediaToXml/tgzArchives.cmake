@@ -0,0 +1,30 @@
+# Test writing the output files into gzip compressed tar archives (option --tgz)
+# Usage: cmake -DTESTBIN=<program> -DINPUT=<inputfile> -DWORKDIR=<dir> -DOPTIONS_EXPECTED=<options> -DOPTIONS=<options> -P tgzArchives.cmake
+#	OPTIONS_EXPECTED	options of the run producing the expected output files (e.g. a plain single threaded run)
+#	OPTIONS			options of the run tested writing archives, the files extracted from them have to be equal to the expected ones
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+run_converter_clean( ${WORKDIR}/expected "${OPTIONS_EXPECTED}" ${INPUT})
+run_converter_clean( ${WORKDIR}/archives "${OPTIONS}" ${INPUT})
+
+file( GLOB ARCHIVES ${WORKDIR}/archives/*)
+list( LENGTH ARCHIVES NOF_ARCHIVES)
+if (NOF_ARCHIVES EQUAL 0)
+	message( FATAL_ERROR "no archives written to ${WORKDIR}/archives" )
+endif()
+file( REMOVE_RECURSE ${WORKDIR}/result)
+file( MAKE_DIRECTORY ${WORKDIR}/result)
+foreach (ARCHIVE ${ARCHIVES})
+	if (NOT ARCHIVE MATCHES "[.]tar[.]gz$")
+		message( FATAL_ERROR "unexpected file ${ARCHIVE} in ${WORKDIR}/archives, archive not completed" )
+	endif()
+	execute_process(
+		COMMAND ${CMAKE_COMMAND} -E tar xzf ${ARCHIVE}
+		WORKING_DIRECTORY ${WORKDIR}/result
+		RESULT_VARIABLE RES )
+	if (NOT RES EQUAL 0)
+		message( FATAL_ERROR "failed to extract archive ${ARCHIVE}" )
+	endif()
+endforeach()
+message( "${NOF_ARCHIVES} archives extracted" )
+compare_output_dirs( ${WORKDIR}/expected ${WORKDIR}/result)
@@ -0,0 +1,14 @@
+# Test the report of output files that could not be written
+# Usage: cmake -DTESTBIN=<program> -DINPUT=<inputfile> -DWORKDIR=<dir> -DOPTIONS=<options> -DTITLE=<title> -P writeErrors.cmake
+#	The output file of the document TITLE is blocked by a directory with the same name, its write has to fail and to be reported in the summary.
+include( ${CMAKE_CURRENT_LIST_DIR}/testUtils.cmake )
+
+string( REPLACE " " "_" FILENAME "${TITLE}")
+set( OUTDIR ${WORKDIR}/out )
+file( REMOVE_RECURSE ${OUTDIR})
+file( WRITE ${OUTDIR}/0000/${FILENAME}.xml/blocked "file blocking the output file of '${TITLE}'")
+
+run_converter( ${OUTDIR} "${OPTIONS}" ${INPUT})
+if (NOT CONVERTER_ERRORS MATCHES "1 output files could not be written or removed:\n\t[^\n]*/0000/${FILENAME}[.]xml\n")
+	message( FATAL_ERROR "failed write of ${FILENAME}.xml not reported:\n${CONVERTER_ERRORS}" )
+endif()